@@ -0,0 +1,309 @@
+# Compiles settings.json into a header (see Source/Includes/Configs_Parser.h):
+#   - the json itself, embedded as raw string literals, so the plugin never reads settings.json from disk
+#   - the event communication, thread, preset, inference and debugging settings as constexpr values
+#   - the UI, visualizer and standalone transport flags as constexpr values (see UIObjects in Configs_Parser.h)
+#   - the parameter descriptors of the UI widgets (see generated_settings::parameters), so the parameter layout,
+#     the preset exclusions and GuiParams don't need the json (only the editor parses it, to lay out the tabs)
+#
+#   nmfx_generate_settings_header(<settings.json> <output header>)
+#
+# Runs at configure time (string(JSON) needs CMake 3.19+, see the root CMakeLists.txt), and again whenever
+# settings.json changes.
+# The header is only rewritten if its content changed, so unrelated re-configures don't trigger rebuilds.
+
+# settings that older settings.json files may not have (namespace|name|type|value)
+set(NMFX_SETTINGS_DEFAULTS
+        "debugging_settings::DeploymentThread|benchmark_variation_bank_on_load|bool|false"
+        "debugging_settings::APVTSMediatorThread|print_loaded_preset_data|bool|false"
+        "debugging_settings::APVTSMediatorThread|benchmark_preset_encodings|bool|false"
+        "preset_settings|compression_threshold_kb|int|-1"
+        "preset_settings|store_as_fp16|bool|false"
+        "preset_settings|compression_level|int|6"
+        "inference_settings|auto_tune_num_threads_on_load|bool|false"
+        "inference_settings|inference_host_hang_timeout_ms|int|60000"
+        "generated_settings::UI|resizable|bool|false"
+        "generated_settings::UI|maintain_aspect_ratio|bool|false"
+        "generated_settings::UI|width|int|800"
+        "generated_settings::UI|height|int|600"
+        "generated_settings::Tabs|show_grid|bool|false"
+        "generated_settings::Tabs|draw_borders_for_components|bool|false"
+        "generated_settings::MidiInVisualizer|enable|bool|false"
+        "generated_settings::MidiInVisualizer|allowToDragInMidi|bool|false"
+        "generated_settings::MidiInVisualizer|visualizeIncomingMidiFromHost|bool|false"
+        "generated_settings::MidiInVisualizer|deletePreviousIncomingMidiMessagesOnBackwardPlayhead|bool|false"
+        "generated_settings::MidiInVisualizer|deletePreviousIncomingMidiMessagesOnRestart|bool|false"
+        "generated_settings::GeneratedContentVisualizer|enable|bool|false"
+        "generated_settings::GeneratedContentVisualizer|allowToDragOutAsMidi|bool|false"
+        "generated_settings::VirtualMidiOut|enable|bool|false"
+        "generated_settings::StandaloneTransportPanel|enable|bool|false"
+        "generated_settings::StandaloneTransportPanel|disableInPluginMode|bool|false"
+        "generated_settings::StandaloneTransportPanel|exclude_tempo_from_presets|bool|false"
+        "generated_settings::StandaloneTransportPanel|exclude_time_signature_from_presets|bool|false"
+        "generated_settings::StandaloneTransportPanel|exclude_record_button_from_presets|bool|false"
+        "generated_settings::StandaloneTransportPanel|exclude_play_button_from_presets|bool|false"
+        )
+
+# converts a json scalar to a c++ type/literal (empty type if not a scalar)
+function(_nmfx_cxx_value json_type json_value out_type out_value)
+    if(json_type STREQUAL "BOOLEAN")
+        if(json_value)
+            set(${out_type} "bool" PARENT_SCOPE)
+            set(${out_value} "true" PARENT_SCOPE)
+        else()
+            set(${out_type} "bool" PARENT_SCOPE)
+            set(${out_value} "false" PARENT_SCOPE)
+        endif()
+    elseif(json_type STREQUAL "NUMBER")
+        if(json_value MATCHES "[.eE]")
+            set(${out_type} "double" PARENT_SCOPE)
+        else()
+            set(${out_type} "int" PARENT_SCOPE)
+        endif()
+        set(${out_value} "${json_value}" PARENT_SCOPE)
+    else()
+        set(${out_type} "" PARENT_SCOPE)
+    endif()
+endfunction()
+
+# emits a constexpr per scalar member of the json object at <path...> into namespace <ns>
+# (the defaults of NMFX_SETTINGS_DEFAULTS are used for members that are missing)
+function(_nmfx_emit_section settings ns out_var)
+    set(path ${ARGN})
+    set(body "")
+    set(emitted "")
+
+    string(JSON num_members ERROR_VARIABLE error LENGTH "${settings}" ${path})
+    if(NOT error AND num_members GREATER 0)
+        math(EXPR last "${num_members} - 1")
+        foreach(i RANGE ${last})
+            string(JSON name MEMBER "${settings}" ${path} ${i})
+            string(JSON json_type TYPE "${settings}" ${path} ${name})
+            string(JSON json_value GET "${settings}" ${path} ${name})
+            _nmfx_cxx_value("${json_type}" "${json_value}" cxx_type cxx_value)
+            if(cxx_type)
+                string(APPEND body "constexpr ${cxx_type} ${name}{${cxx_value}};\n")
+                list(APPEND emitted ${name})
+            endif()
+        endforeach()
+    endif()
+
+    foreach(default ${NMFX_SETTINGS_DEFAULTS})
+        string(REPLACE "|" ";" default "${default}")
+        list(GET default 0 default_ns)
+        list(GET default 1 name)
+        list(GET default 2 cxx_type)
+        list(GET default 3 cxx_value)
+        list(FIND emitted ${name} index)
+        if(default_ns STREQUAL ns AND index EQUAL -1)
+            string(APPEND body "constexpr ${cxx_type} ${name}{${cxx_value}};     // default\n")
+        endif()
+    endforeach()
+
+    set(${out_var} "${${out_var}}namespace ${ns} {\n${body}}\n\n" PARENT_SCOPE)
+endfunction()
+
+# true/false for a json boolean at <path...> (false if missing)
+function(_nmfx_json_bool settings out_var)
+    string(JSON json_type ERROR_VARIABLE error TYPE "${settings}" ${ARGN})
+    set(${out_var} "false" PARENT_SCOPE)
+    if(NOT error AND json_type STREQUAL "BOOLEAN")
+        string(JSON json_value GET "${settings}" ${ARGN})
+        if(json_value)
+            set(${out_var} "true" PARENT_SCOPE)
+        endif()
+    endif()
+endfunction()
+
+# json number at <path...> (fails the configure step if missing, the widget can't be created without it)
+function(_nmfx_json_number settings out_var)
+    string(JSON json_type ERROR_VARIABLE error TYPE "${settings}" ${ARGN})
+    if(error OR NOT json_type STREQUAL "NUMBER")
+        string(REPLACE ";" "/" path "${ARGN}")
+        message(FATAL_ERROR "settings.json: ${path} is missing or not a number")
+    endif()
+    string(JSON json_value GET "${settings}" ${ARGN})
+    set(${out_var} "${json_value}" PARENT_SCOPE)
+endfunction()
+
+# string at <path...> as a c++ string literal
+function(_nmfx_json_label settings out_var)
+    string(JSON json_type ERROR_VARIABLE error TYPE "${settings}" ${ARGN})
+    if(error OR NOT json_type STREQUAL "STRING")
+        string(REPLACE ";" "/" path "${ARGN}")
+        message(FATAL_ERROR "settings.json: ${path} is missing or not a string")
+    endif()
+    string(JSON label GET "${settings}" ${ARGN})
+    string(REPLACE "\\" "\\\\" label "${label}")
+    string(REPLACE "\"" "\\\"" label "${label}")
+    set(${out_var} "\"${label}\"" PARENT_SCOPE)
+endfunction()
+
+# descriptors of the parameters created for the widgets of UI.Tabs.tabList, per tab in the order
+# createParameterLayout() adds them (vertical sliders, rotaries, buttons, horizontal sliders, comboBoxes,
+# triangle slider axes), followed by the midi/audio displays (no apvts parameter) and the widgets that only
+# matter for the preset exclusions (kind None)
+function(_nmfx_emit_parameters settings out_var)
+    set(rows "")
+    set(item_lists "")
+    set(num_rows 0)
+
+    string(JSON num_tabs ERROR_VARIABLE error LENGTH "${settings}" UI Tabs tabList)
+    if(error)
+        set(num_tabs 0)
+    endif()
+
+    if(num_tabs GREATER 0)
+        math(EXPR last_tab "${num_tabs} - 1")
+        foreach(t RANGE ${last_tab})
+            foreach(group vsliders rotaries buttons hsliders comboBoxes triangleSliders hslidersKey MidiDisplays AudioDisplays)
+                set(key ${group})
+                if(group STREQUAL "vsliders" OR group STREQUAL "hsliders")
+                    set(key sliders)
+                elseif(group STREQUAL "hslidersKey")
+                    set(key hsliders)       # only read by the preset exclusions
+                endif()
+
+                string(JSON num_widgets ERROR_VARIABLE error LENGTH "${settings}" UI Tabs tabList ${t} ${key})
+                if(error OR num_widgets EQUAL 0)
+                    continue()
+                endif()
+
+                math(EXPR last_widget "${num_widgets} - 1")
+                foreach(w RANGE ${last_widget})
+                    set(path UI Tabs tabList ${t} ${key} ${w})
+                    _nmfx_json_bool("${settings}" exclude ${path} exclude_from_presets)
+
+                    if(group STREQUAL "vsliders" OR group STREQUAL "hsliders")
+                        _nmfx_json_bool("${settings}" horizontal ${path} horizontal)
+                        if((group STREQUAL "vsliders" AND horizontal) OR (group STREQUAL "hsliders" AND NOT horizontal))
+                            continue()
+                        endif()
+                    endif()
+
+                    if(group STREQUAL "triangleSliders")
+                        foreach(axis DistanceFromBottomLeftCornerSlider HeightSlider)
+                            string(JSON ignored ERROR_VARIABLE error GET "${settings}" ${path} ${axis})
+                            if(error)
+                                message(WARNING "settings.json: triangle slider missing ${axis}, skipped")
+                                break()
+                            endif()
+                        endforeach()
+                        if(error)
+                            continue()
+                        endif()
+                        # the height starts half way (GuiParams only, the apvts parameter defaults to 0)
+                        _nmfx_json_label("${settings}" label_a ${path} DistanceFromBottomLeftCornerSlider)
+                        _nmfx_json_label("${settings}" label_b ${path} HeightSlider)
+                        string(APPEND rows "    {ParamKind::TriangleSliderAxis, ${label_a}, 0, 1, 0, 0, nullptr, false, false},\n")
+                        string(APPEND rows "    {ParamKind::TriangleSliderAxis, ${label_b}, 0, 1, 0.5, 0, nullptr, false, false},\n")
+                        math(EXPR num_rows "${num_rows} + 2")
+                        continue()
+                    endif()
+
+                    _nmfx_json_label("${settings}" label ${path} label)
+                    if(group STREQUAL "vsliders" OR group STREQUAL "hsliders" OR group STREQUAL "rotaries")
+                        set(kind Slider)
+                        if(group STREQUAL "rotaries")
+                            set(kind Rotary)
+                        endif()
+                        _nmfx_json_number("${settings}" min ${path} min)
+                        _nmfx_json_number("${settings}" max ${path} max)
+                        _nmfx_json_number("${settings}" default ${path} default)
+                        string(APPEND rows "    {ParamKind::${kind}, ${label}, ${min}, ${max}, ${default}, 0, nullptr, false, ${exclude}},\n")
+                    elseif(group STREQUAL "buttons")
+                        _nmfx_json_bool("${settings}" is_toggle ${path} isToggle)
+                        string(APPEND rows "    {ParamKind::Button, ${label}, 0, 1, 0, 0, nullptr, ${is_toggle}, ${exclude}},\n")
+                    elseif(group STREQUAL "comboBoxes")
+                        string(JSON num_items ERROR_VARIABLE error LENGTH "${settings}" ${path} items)
+                        if(error)
+                            set(num_items 0)
+                        endif()
+                        set(items nullptr)
+                        if(num_items GREATER 0)
+                            set(items "combo_box_items_${num_rows}")
+                            set(list "")
+                            math(EXPR last_item "${num_items} - 1")
+                            foreach(i RANGE ${last_item})
+                                _nmfx_json_label("${settings}" item ${path} items ${i})
+                                string(APPEND list "${item}, ")
+                            endforeach()
+                            string(APPEND item_lists "inline constexpr const char* ${items}[] = {${list}};\n")
+                        endif()
+                        string(APPEND rows "    {ParamKind::ComboBox, ${label}, 0, 0, 0, ${num_items}, ${items}, false, ${exclude}},\n")
+                    elseif(group STREQUAL "MidiDisplays")
+                        string(APPEND rows "    {ParamKind::MidiDisplay, ${label}, 0, 0, 0, 0, nullptr, false, ${exclude}},\n")
+                    elseif(group STREQUAL "AudioDisplays")
+                        string(APPEND rows "    {ParamKind::AudioDisplay, ${label}, 0, 0, 0, 0, nullptr, false, ${exclude}},\n")
+                    else()
+                        string(APPEND rows "    {ParamKind::None, ${label}, 0, 0, 0, 0, nullptr, false, ${exclude}},\n")
+                    endif()
+                    math(EXPR num_rows "${num_rows} + 1")
+                endforeach()
+            endforeach()
+        endforeach()
+    endif()
+
+    set(body "namespace generated_settings {\n")
+    string(APPEND body "enum class ParamKind { Slider, Rotary, Button, ComboBox, TriangleSliderAxis, MidiDisplay, AudioDisplay, None };\n\n")
+    string(APPEND body "struct ParamDescriptor {\n")
+    string(APPEND body "    ParamKind kind;\n    const char* label;\n    double min;\n    double max;\n")
+    string(APPEND body "    double default_value;\n    int num_items;             // comboBoxes\n")
+    string(APPEND body "    const char* const* items;  // comboBoxes (num_items entries)\n")
+    string(APPEND body "    bool is_toggle;            // buttons\n")
+    string(APPEND body "    bool exclude_from_presets;\n};\n\n")
+    string(APPEND body "${item_lists}\n")
+    string(APPEND body "inline constexpr std::array<ParamDescriptor, ${num_rows}> parameters{{\n${rows}}};\n}\n\n")
+    set(${out_var} "${${out_var}}${body}" PARENT_SCOPE)
+endfunction()
+
+function(nmfx_generate_settings_header settings_file output_file)
+    file(READ "${settings_file}" settings)
+    string(JSON ignored ERROR_VARIABLE error TYPE "${settings}")
+    if(error)
+        message(FATAL_ERROR "${settings_file} is not valid json: ${error}")
+    endif()
+
+    set(header "// Generated from ${settings_file} by CMake/GenerateSettingsHeader.cmake -- DO NOT EDIT\n")
+    string(APPEND header "#pragma once\n\n#include <array>\n\n")
+
+    # MSVC limits string literals to ~16KB, so the json is split into chunks
+    set(chunk_size 8000)
+    string(LENGTH "${settings}" length)
+    string(APPEND header "namespace generated_settings {\n")
+    string(APPEND header "inline constexpr const char* settings_json_chunks[] = {\n")
+    set(position 0)
+    while(position LESS length)
+        string(SUBSTRING "${settings}" ${position} ${chunk_size} chunk)
+        string(APPEND header "R\"nmfx_settings(${chunk})nmfx_settings\",\n")
+        math(EXPR position "${position} + ${chunk_size}")
+    endwhile()
+    string(APPEND header "};\n}\n\n")
+
+    _nmfx_emit_section("${settings}" "event_communication_settings" header event_communication_settings)
+    _nmfx_emit_section("${settings}" "preset_settings" header preset_settings)
+    _nmfx_emit_section("${settings}" "inference_settings" header inference_settings)
+    foreach(thread DeploymentThread APVTSMediatorThread ProcessorThread)
+        _nmfx_emit_section("${settings}" "debugging_settings::${thread}" header debugging_settings ${thread})
+    endforeach()
+    _nmfx_emit_section("${settings}" "generated_settings::UI" header UI)
+    _nmfx_emit_section("${settings}" "generated_settings::Tabs" header UI Tabs)
+    _nmfx_emit_section("${settings}" "generated_settings::MidiInVisualizer" header UI MidiInVisualizer)
+    _nmfx_emit_section("${settings}" "generated_settings::GeneratedContentVisualizer" header UI GeneratedContentVisualizer)
+    _nmfx_emit_section("${settings}" "generated_settings::VirtualMidiOut" header VirtualMidiOut)
+    _nmfx_emit_section("${settings}" "generated_settings::StandaloneTransportPanel" header StandaloneTransportPanel)
+    _nmfx_emit_parameters("${settings}" header)
+
+    string(JSON wait_time ERROR_VARIABLE error GET "${settings}" deploy_method_min_wait_time_between_iterations)
+    if(error)
+        set(wait_time 0.5)
+    endif()
+    string(APPEND header "namespace thread_configurations::SingleMidiThread {\n")
+    string(APPEND header "constexpr double waitTimeBtnIters{${wait_time}};\n}\n")
+
+    file(WRITE "${output_file}.tmp" "${header}")
+    configure_file("${output_file}.tmp" "${output_file}" COPYONLY)
+    file(REMOVE "${output_file}.tmp")
+
+    # re-configure (and regenerate) when settings.json is edited
+    set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS "${settings_file}")
+endfunction()
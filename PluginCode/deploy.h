@@ -2,6 +2,52 @@
 #pragma once
 
 #include "Source/DeploymentThreads/DeploymentThread.h"
+#include "Source/Includes/InferenceBackend.h"
+#include "Source/Includes/LRUCache.h"
+#include "Source/Includes/RegenerationScheduler.h"
+#include "Source/Includes/SpeculativeJobThread.h"
+#include "Source/Includes/ThreadCountTuner.h"
+#include <ATen/CPUGeneratorImpl.h>
+
+// parameters passed to the sample() method of the model
+struct SamplingParams {
+    torch::Tensor voice_thresholds;
+    torch::Tensor max_counts_allowed;
+    int sampling_mode{0};
+    float temperature{1.0f};
+};
+
+// output of the sample() method of the model
+struct GeneratedPattern {
+    torch::Tensor hits;
+    torch::Tensor velocities;
+    torch::Tensor offsets;
+    torch::Tensor hit_logits;   // raw decoder output (only defined if the model exposes decode())
+
+    // false if the inference failed (see InferenceBackend::run)
+    [[nodiscard]] bool isValid() const { return hits.defined(); }
+};
+
+// identifies a generated pattern in the variation cache
+struct PatternKey {
+    uint64_t groove_hash{0};
+    int density_bucket{0};
+    float temperature{1.0f};
+    uint64_t thresholds_hash{0};
+
+    bool operator==(const PatternKey &other) const {
+        return groove_hash == other.groove_hash && density_bucket == other.density_bucket &&
+               temperature == other.temperature && thresholds_hash == other.thresholds_hash;
+    }
+};
+
+struct PatternKeyHash {
+    size_t operator()(const PatternKey &key) const {
+        uint64_t h = hash_combine(key.groove_hash, (uint64_t) key.density_bucket);
+        h = hash_combine(h, hash_bytes(&key.temperature, sizeof(key.temperature)));
+        return (size_t) hash_combine(h, key.thresholds_hash);
+    }
+};
 
 class PluginDeploymentThread: public DeploymentThread {
 public:
@@ -10,6 +56,22 @@ public:
 
     }
 
+    // selects the next/previous variation in the variation bank (can be called from any thread)
+    // switching between variations doesn't require any inference
+    void nextVariation() { requestedVariationStep += 1; requestDeployCall(); }
+    void previousVariation() { requestedVariationStep -= 1; requestDeployCall(); }
+
+    // number of generation requests served by (or missed in) the groove memoization
+    [[nodiscard]] uint64_t getMemoizationHits() const { return memoization_hits; }
+    [[nodiscard]] uint64_t getMemoizationMisses() const { return memoization_misses; }
+
+    // number of scheduled regenerations whose results were sent before/after their target boundary
+    [[nodiscard]] uint64_t getRegenerationsOnTime() const { return regenerationScheduler.getNumOnTime(); }
+    [[nodiscard]] uint64_t getRegenerationsLate() const { return regenerationScheduler.getNumLate(); }
+    [[nodiscard]] std::array<uint64_t, RegenerationScheduler::num_overrun_bins> getRegenerationOverrunHistogram() const {
+        return regenerationScheduler.getOverrunHistogram();
+    }
+
     // this method runs on a per-event basis.
     // the majority of the deployment will be done here!
     std::pair<bool, bool> deploy (
@@ -23,7 +85,30 @@ public:
 
         // Try loading the model if it hasn't been loaded yet
         if (!isModelLoaded) {
-            load("drumLoopVAE.pt");
+            if (load("drumLoopVAE.pt")) {
+                backend = getBackend(BackendType::TorchScriptFp32);
+                if (inference_settings::auto_tune_num_threads_on_load) {
+                    tuneNumThreads();
+                }
+            }
+        }
+
+        // switch between the available inference backends if requested
+        bool backendChanged = false;
+        if (gui_params.wasParamUpdated("InferenceBackend") && isModelLoaded) {
+            backendChanged = selectBackend(
+                backendTypeFromText(gui_params.getComboBoxSelectionText("InferenceBackend")));
+        }
+
+        if (gui_params.wasButtonClicked("CompareBackends") && isModelLoaded) {
+            compareBackends();
+        }
+
+        // prints batched vs single call timings (debugging_settings.DeploymentThread in settings.json)
+        if (debugging_settings::DeploymentThread::benchmark_variation_bank_on_load &&
+            isModelLoaded && !variationBankBenchmarked) {
+            benchmarkVariationBank();
+            variationBankBenchmarked = true;
         }
 
         // Check if voice map should be updated
@@ -38,22 +123,106 @@ public:
         // check if density has been updated
         if (gui_params.wasParamUpdated("Density")) {
             density = gui_params.getValueFor("Density");
+            densityChangedSinceLastGeneration = true;
             shouldEncodeGroove = true;
         }
 
-        // encode the groove if necessary
-        if (shouldEncodeGroove) {
-            if (isModelLoaded) {
-                encodeGroove();
-                generatePattern();
+        // threshold/max count/temperature/mode changes are re-applied to the cached decoder output
+        // without inference (a full regeneration is only needed if the model doesn't expose decode())
+        // either way, the change is applied in the next slot of the selected cadence
+        bool samplingChanged = false;
+        if (updateSamplingParams() && isModelLoaded) {
+            samplingChanged = true;
+            if (variationBank.hit_logits.defined()) {
+                samplingChangedSinceLastGeneration = true;
+            } else {
+                shouldEncodeGroove = true;
             }
         }
 
+        // check if the regeneration cadence has been updated
+        if (gui_params.wasParamUpdated("RegenerationCadence")) {
+            regenerationScheduler.setCadenceFromText(
+                gui_params.getComboBoxSelectionText("RegenerationCadence"));
+        }
+
+        // regenerations are deferred to the next slot of the selected cadence (latest wins)
+        if (shouldEncodeGroove || backendChanged) {
+            regenerationRequiresInference = true;
+        }
+        if (shouldEncodeGroove || backendChanged || samplingChanged) {
+            regenerationScheduler.request();
+        }
+
+        // encode the groove if its slot has come
+        bool regenerated = false;
+        if (isModelLoaded && regenerationScheduler.shouldRunNow(realtimePlaybackInfo->get())) {
+            auto inputs_hash = generationInputsHash();
+            if (last_generation_inputs_hash == inputs_hash) {
+                // identical groove/density/sampling params (i.e. a looped input replaying the same
+                // onsets), the current pattern is still valid so there is nothing to (re)send
+                memoization_hits++;
+            } else {
+                memoization_misses++;
+                if (!regenerationRequiresInference && samplingChangedSinceLastGeneration &&
+                    variationBank.hit_logits.defined()) {
+                    // only the sampling params changed, re-applied to the decoder output of the current bank
+                    variationBank = applySamplingParams(variationBank, currentSamplingParams());
+                    selectVariation(selectedVariation);
+                    regenerated = true;
+                } else if (densityChangedSinceLastGeneration && loadPatternFromVariationCache()) {
+                    // served instantly from the cache (the cached bank is final, see generateDetached())
+                    requestSpeculativePatterns();
+                    regenerated = true;
+                } else if (encodeGroove() && generatePattern()) {
+                    // coming back to this density later serves the same bank
+                    variationCache.put(makePatternKey(densityToBucket(density)), variationBank);
+                    requestSpeculativePatterns();
+                    regenerated = true;
+                } else {
+                    // the backend failed (already logged), the current pattern keeps playing
+                    PrintMessage("Inference failed, generation skipped");
+                }
+                if (regenerated) {
+                    last_generation_inputs_hash = inputs_hash;
+                }
+            }
+            densityChangedSinceLastGeneration = false;
+            samplingChangedSinceLastGeneration = false;
+            regenerationRequiresInference = false;
+        }
+
+        // results that missed their deadline are held back (the previous pattern keeps playing)
+        // and released just before the next boundary
+        if (regenerated && !regenerationScheduler.registerResultReady(realtimePlaybackInfo->get())) {
+            PrintMessage("Regeneration missed its deadline, holding the result until the next boundary");
+            PrintMessage(regenerationScheduler.getDeadlineReport());
+        }
+        bool heldResultReleased = regenerationScheduler.shouldReleaseHeldResult(realtimePlaybackInfo->get());
+
+        // keep polling until the slot of the pending regeneration (or held result) comes
+        if (regenerationScheduler.isPending() || regenerationScheduler.hasHeldResult()) {
+            requestDeployCall();
+        }
+
+        // check if another variation has been requested (via gui or API)
+        bool variationChanged = updateSelectedVariation();
+
         // if the voice map has changed, or a new pattern has been generated,
-        // prepare the playback sequence
-        if ((voiceMapChanged || shouldEncodeGroove) && isModelLoaded) {
+        // prepare the playback sequence (unless a result is being held back, any change
+        // is then sent along with it when it is released)
+        bool patternChanged = regenerated || variationChanged || heldResultReleased;
+
+        // if only the voice map has changed, the notes of the stream being played are remapped in place
+        if (voiceMapChanged && !patternChanged && sendNoteRemapIfPossible()) {
+            voiceMapChanged = false;
+        }
+
+        bool shouldSend = voiceMapChanged || patternChanged;
+        if (shouldSend && !regenerationScheduler.hasHeldResult() && isModelLoaded) {
             preparePlaybackSequence();
             preparePlaybackPolicy();
+            sentVoiceMap = voiceMap;
             return {true, true};
         }
 
@@ -66,11 +235,14 @@ private:
     float density = 0.5f;
 
     // following will be used for the inference
-    // contains the above information in a single tensor of shape (1, 32, 27)
-    torch::Tensor groove_hvo = torch::zeros({1, 32, 27}, torch::kFloat32);
-    torch::Tensor groove_hits = torch::zeros({1, 32, 1}, torch::kFloat32);
-    torch::Tensor groove_velocities = torch::zeros({1, 32, 1}, torch::kFloat32);
-    torch::Tensor groove_offsets = torch::zeros({1, 32, 1}, torch::kFloat32);
+    // groove accumulator laid out as the (1, 32, 27) hvo tensor expected by the model
+    // (plain array updated with plain stores, exposed to the model as a tensor only at encode time)
+    static constexpr int groove_steps = 32;
+    static constexpr int groove_channels = 27;
+    static constexpr int groove_hit_channel = 2;           // the groove is placed on the closed hat voice
+    static constexpr int groove_velocity_channel = 11;
+    static constexpr int groove_offset_channel = 20;
+    float groove_hvo[groove_steps][groove_channels]{};
 
     // add any member variables or methods you need here
     torch::Tensor latent_vector = torch::zeros({1, 128}, torch::kFloat32);
@@ -79,11 +251,80 @@ private:
     int sampling_mode = 0;
     float temperature = 1.0f;
     std::map<int, int> voiceMap;
+    std::optional<std::map<int, int>> sentVoiceMap;    // voice map used for the stream last sent for playback
 
     torch::Tensor hits;
     torch::Tensor velocities;
     torch::Tensor offsets;
 
+    // variation bank
+    // each generation samples num_variations latents in a single batched call of sample(),
+    // hits/velocities/offsets above always hold the currently selected variation (batch size of 1)
+    static constexpr int num_variations = 8;
+    GeneratedPattern variationBank;
+    int selectedVariation{0};
+    std::atomic<int> requestedVariationStep{0};
+    bool variationBankBenchmarked{false};
+
+    // groove memoization
+    // hash of everything that affects a generation, for the pattern that is currently held
+    std::optional<uint64_t> last_generation_inputs_hash;
+    std::atomic<uint64_t> memoization_hits{0};
+    std::atomic<uint64_t> memoization_misses{0};
+
+    // inference backends (see InferenceBackend.h)
+    // the TorchScript fp32 backend wraps the model loaded by load(), the others are loaded lazily the first time
+    // they are selected: the int8 (dynamically quantized linear/GRU layers) TorchScript export of the same model,
+    // and its ONNX export run with ONNX Runtime (only if built with NMFX_WITH_ONNXRUNTIME), and the same fp32
+    // TorchScript model run by the inference host process (only if built with NMFX_BUILD_INFERENCE_HOST)
+    enum class BackendType { TorchScriptFp32, TorchScriptInt8, OnnxRuntime, OutOfProcess };
+    static constexpr const char* quantized_model_name = "drumLoopVAE_q8.pt";
+    static constexpr const char* onnx_model_name = "drumLoopVAE.onnx";
+    std::map<BackendType, std::shared_ptr<InferenceBackend>> backends;  // nullptr if not available
+    std::map<BackendType, size_t> backendLoadMemoryKB;                 // resident memory added by loading
+    std::shared_ptr<InferenceBackend> backend;                          // selected backend
+    BackendType selectedBackend{BackendType::TorchScriptFp32};
+
+    // intra-op thread count, tuned once per model file/cpu (see ThreadCountTuner.h)
+    // only if inference_settings.auto_tune_num_threads_on_load is set in settings.json
+    std::optional<int> num_inference_threads;
+
+    // regeneration scheduling (see RegenerationScheduler.h)
+    RegenerationScheduler regenerationScheduler;
+    bool densityChangedSinceLastGeneration{false};
+    bool samplingChangedSinceLastGeneration{false};    // can be re-applied without inference
+    bool regenerationRequiresInference{false};          // groove, density or backend changed
+
+    // speculative variation cache
+    // patterns for quantized densities close to the current one (and the current groove) are precomputed
+    // in the background, so that density changes can be served without waiting for inference
+    static constexpr int num_density_buckets = 20;      // density is quantized in steps of 1/20
+    static constexpr int num_speculated_neighbours = 2;  // precompute buckets within +-2 of the current one
+    LRUCache<PatternKey, GeneratedPattern, PatternKeyHash> variationCache{128};
+
+    // checks if any of the sampling controls have been updated
+    // returns true if any of the sampling parameters have changed
+    bool updateSamplingParams() {
+        bool changed = false;
+        if (gui_params.wasParamUpdated("Threshold")) {
+            voice_thresholds = torch::ones({ 9 }, torch::kFloat32) * gui_params.getValueFor("Threshold");
+            changed = true;
+        }
+        if (gui_params.wasParamUpdated("MaxHitsPerVoice")) {
+            max_counts_allowed = torch::ones({ 9 }, torch::kFloat32) * gui_params.getValueFor("MaxHitsPerVoice");
+            changed = true;
+        }
+        if (gui_params.wasParamUpdated("Temperature")) {
+            temperature = (float) gui_params.getValueFor("Temperature");
+            changed = true;
+        }
+        if (gui_params.wasParamUpdated("SamplingMode")) {
+            sampling_mode = gui_params.getComboBoxSelectionText("SamplingMode") == "Bernoulli" ? 1 : 0;
+            changed = true;
+        }
+        return changed;
+    }
+
     // checks if any of the voice map parameters have been updated and updates the voice map
     // returns true if the voice map has been updated
     bool updateVoiceMap() {
@@ -127,6 +368,29 @@ private:
         return voiceMapChanged;
     }
 
+    // sends a note remap table (sentVoiceMap --> voiceMap) instead of a new stream
+    // returns false if not possible (nothing sent yet, or two voices sharing a note are now mapped apart)
+    bool sendNoteRemapIfPossible() {
+        if (!sentVoiceMap.has_value()) {
+            return false;
+        }
+
+        NoteRemapTable table;
+        std::map<int, int> targets;     // sent note --> new note
+        for (const auto& [voice, sent_note] : *sentVoiceMap) {
+            auto new_note = voiceMap[voice];
+            auto it = targets.find(sent_note);
+            if (it != targets.end() && it->second != new_note) {
+                return false;
+            }
+            targets[sent_note] = new_note;
+            table.set(sent_note, new_note);
+        }
+
+        sendNoteRemap(table);
+        return true;
+    }
+
     // checks if a new host event has been received and
     // updates the input tensor accordingly
     bool updateGrooveUsingHostEvent(std::optional<EventFromHost> & new_event) {
@@ -138,9 +402,7 @@ private:
         
         if (new_event->isFirstBufferEvent()) {
             // clear hits, velocities, offsets
-            groove_hits = torch::zeros({1, 32, 1}, torch::kFloat32);
-            groove_velocities = torch::zeros({1, 32, 1}, torch::kFloat32);
-            groove_offsets = torch::zeros({1, 32, 1}, torch::kFloat32);
+            std::fill(&groove_hvo[0][0], &groove_hvo[0][0] + groove_steps * groove_channels, 0.0f);
         }
         
         if (new_event->isNoteOnEvent()) {
@@ -148,89 +410,464 @@ private:
             auto velocity = new_event->getVelocity(); // velocity
             auto div = round(ppq / .25f);
             auto offset = (ppq - (div * .25f)) / 0.125 * 0.5 ;
-            auto grid_index = (long long) fmod(div, 32);
+            auto grid_index = (long long) fmod(div, groove_steps);
+
+            auto &step = groove_hvo[grid_index];
 
             // check if louder if overlapping
-            if (groove_hits[0][grid_index][0].item<float>() > 0) {
-                if (groove_velocities[0][grid_index][0].item<float>() < velocity) {
-                    groove_velocities[0][grid_index][0] = velocity;
-                    groove_offsets[0][grid_index][0] = offset;
+            if (step[groove_hit_channel] > 0) {
+                if (step[groove_velocity_channel] < velocity) {
+                    step[groove_velocity_channel] = velocity;
+                    step[groove_offset_channel] = (float) offset;
                 }
             } else {
-                groove_hits[0][grid_index][0] = 1;
-                groove_velocities[0][grid_index][0] = velocity;
-                groove_offsets[0][grid_index][0] = offset;
+                step[groove_hit_channel] = 1;
+                step[groove_velocity_channel] = velocity;
+                step[groove_offset_channel] = (float) offset;
             }
         }
         
-
-        // stack up the groove information into a single tensor
-        groove_hvo = torch::concat(
-            {
-                groove_hits,
-                groove_velocities,
-                groove_offsets
-            }, 2);
-
-        // ignore the operations (I'm just changing the formation of the tensor)
-        groove_hvo = torch::zeros({1, 32, 27});
-        groove_hvo.index_put_(
-            {torch::indexing::Ellipsis, 2},
-            groove_hits.index({torch::indexing::Ellipsis, 0}));
-        groove_hvo.index_put_(
-            {torch::indexing::Ellipsis, 11},
-            groove_velocities.index({torch::indexing::Ellipsis, 0}));
-        groove_hvo.index_put_(
-            {torch::indexing::Ellipsis, 20},
-            groove_offsets.index({torch::indexing::Ellipsis, 0}));
-        
         return true;
     }
 
     // encodes the groove into a latent vector using the encoder
-    void encodeGroove() {
+    // returns false if the inference failed (latent_vector is kept)
+    bool encodeGroove() {
+        auto latent = encodeLatent(*backend, grooveAsTensor(), density);
+        if (!latent.defined()) {
+            return false;
+        }
+        latent_vector = latent;
+        return true;
+    }
+
+    // wraps the groove accumulator as a (1, 32, 27) tensor without copying
+    // (the view is only valid as long as groove_hvo is not modified, clone() it if it needs to outlive deploy())
+    torch::Tensor grooveAsTensor() {
+        return torch::from_blob(groove_hvo, {1, groove_steps, groove_channels}, torch::kFloat32);
+    }
+
+    // decodes a random latent vector into a pattern
+    // returns false if the inference failed (the current variation bank is kept)
+    bool generatePattern() {
+        PrintMessage("Generating new sequence...");
+
+        // Generate a batch of random latent vectors (one per variation)
+        latent_vector = torch::randn({ num_variations, 128});
+
+        // Run inference
+        auto bank = samplePattern(*backend, latent_vector, currentSamplingParams());
+        if (!bank.isValid()) {
+            return false;
+        }
+        setVariationBank(bank);
+        return true;
+    }
+
+    // runs the encode() method of the model using the given backend, returns an undefined tensor if it failed
+    // (only reads the model, so it can also be called from the speculative job thread)
+    static torch::Tensor encodeLatent(InferenceBackend &backend_, const torch::Tensor &groove, float density_) {
         // preparing the input to encode() method
-        std::vector<torch::jit::IValue> enc_inputs;
-        enc_inputs.emplace_back(groove_hvo);
+        std::vector<torch::Tensor> enc_inputs;
+        enc_inputs.emplace_back(groove);
         enc_inputs.emplace_back(torch::tensor(
-                                    density,
+                                    density_,
                                     torch::kFloat32).unsqueeze_(0));
 
-        // get the encode method
-        auto encode = model.get_method("encode");
-
         // encode the input
-        auto encoder_output = encode(enc_inputs);
+        auto encoder_output = backend_.run("encode", enc_inputs);
+        if (encoder_output.size() < 3) {
+            return {};
+        }
 
         // get latent vector from encoder output
-        latent_vector = encoder_output.toTuple()->elements()[2].toTensor();
+        return encoder_output[2];
     }
 
-    // decodes a random latent vector into a pattern
-    void generatePattern() {
-        PrintMessage("Generating new sequence...");
-
-        // Generate a random latent vector
-        latent_vector = torch::randn({ 1, 128});
-
-        // Prepare above for inference
-        std::vector<torch::jit::IValue> inputs;
-        inputs.emplace_back(latent_vector);
-        inputs.emplace_back(voice_thresholds);
-        inputs.emplace_back(max_counts_allowed);
-        inputs.emplace_back(sampling_mode);
-        inputs.emplace_back(temperature);
+    // runs the sample() method of the model using the given backend
+    // if the model exposes decode(), the raw decoder output is kept and the sampling is done in
+    // applySamplingParams() instead, so that sampling parameter changes don't require another forward pass
+    // returns an invalid pattern if the inference failed
+    // (only reads the model, so it can also be called from the speculative job thread)
+    static GeneratedPattern samplePattern(InferenceBackend &backend_, const torch::Tensor &latent,
+                                          const SamplingParams &params) {
+        if (backend_.hasMethod("decode")) {
+            auto output = backend_.run("decode", {latent});
+            if (output.size() < 3) {
+                return {};
+            }
+            GeneratedPattern decoded;
+            decoded.hit_logits = output[0];
+            decoded.velocities = output[1];
+            decoded.offsets = output[2];
+            return applySamplingParams(decoded, params);
+        }
 
-        // Get the scripted method
-        auto sample_method = model.get_method("sample");
+        // Prepare above for inference (scalars are passed as 0-dim tensors)
+        std::vector<torch::Tensor> inputs;
+        inputs.emplace_back(latent);
+        inputs.emplace_back(params.voice_thresholds);
+        inputs.emplace_back(params.max_counts_allowed);
+        inputs.emplace_back(torch::tensor((int64_t) params.sampling_mode));
+        inputs.emplace_back(torch::tensor(params.temperature));
 
         // Run inference
-        auto output = sample_method(inputs);
+        auto output = backend_.run("sample", inputs);
+        if (output.size() < 3) {
+            return {};
+        }
 
         // Extract the generated tensors from the output
-        hits = output.toTuple()->elements()[0].toTensor();
-        velocities = output.toTuple()->elements()[1].toTensor();
-        offsets = output.toTuple()->elements()[2].toTensor();
+        GeneratedPattern pattern;
+        pattern.hits = output[0];
+        pattern.velocities = output[1];
+        pattern.offsets = output[2];
+        return pattern;
+    }
+
+    // C++ equivalent of the sampling done in sample(), applied to the raw decoder output
+    //      sampling_mode 0 : hits where sigmoid(logits / temperature) > voice threshold
+    //      sampling_mode 1 : hits drawn from bernoulli(sigmoid(logits / temperature))
+    // then only the max_counts_allowed most probable hits are kept for each voice
+    static GeneratedPattern applySamplingParams(const GeneratedPattern &decoded, const SamplingParams &params) {
+        torch::NoGradGuard no_grad;
+        auto probs = torch::sigmoid(decoded.hit_logits / std::max(params.temperature, 1e-3f));
+
+        // (batch, steps, voices) vs per voice parameters
+        auto thresholds = params.voice_thresholds.view({1, 1, -1});
+        auto max_counts = params.max_counts_allowed.view({1, 1, -1});
+
+        auto candidates = params.sampling_mode == 1 ? torch::bernoulli(probs).to(torch::kBool) : probs > thresholds;
+
+        // rank of each candidate among the candidates of its voice (0 = most probable)
+        auto masked_probs = torch::where(candidates, probs, torch::full_like(probs, -1.0f));
+        auto ranks = masked_probs.argsort(1, true).argsort(1);
+
+        GeneratedPattern pattern = decoded;
+        pattern.hits = (candidates & (ranks < max_counts)).to(torch::kFloat32);
+        return pattern;
+    }
+
+    // same as generatePattern(), without touching the member tensors
+    // (the backend is shared with the background jobs, so switching backends doesn't affect running jobs)
+    // generatePattern() samples random latents and the encoder output isn't used by it, so the encoder isn't run
+    // here: a bank generated for a density bucket is as final as one generated for the exact density
+    static GeneratedPattern generateDetached(const std::shared_ptr<InferenceBackend> &backend_,
+                                             const SamplingParams &params) {
+        torch::NoGradGuard no_grad;
+        return samplePattern(*backend_, torch::randn({ num_variations, 128}), params);
+    }
+
+    // stores a newly generated bank and selects its first variation
+    void setVariationBank(const GeneratedPattern &bank) {
+        variationBank = bank;
+        selectVariation(0);
+    }
+
+    // copies the requested variation of the bank into hits/velocities/offsets
+    void selectVariation(int index) {
+        auto bank_size = (int) variationBank.hits.size(0);
+        selectedVariation = ((index % bank_size) + bank_size) % bank_size;
+        hits = variationBank.hits.slice(0, selectedVariation, selectedVariation + 1);
+        velocities = variationBank.velocities.slice(0, selectedVariation, selectedVariation + 1);
+        offsets = variationBank.offsets.slice(0, selectedVariation, selectedVariation + 1);
+    }
+
+    // checks the variation buttons and the API requests
+    // returns true if a different variation has been selected
+    bool updateSelectedVariation() {
+        int step = requestedVariationStep.exchange(0);
+        if (gui_params.wasButtonClicked("NextVariation")) { step += 1; }
+        if (gui_params.wasButtonClicked("PrevVariation")) { step -= 1; }
+
+        if (step == 0 || !variationBank.hits.defined()) {
+            return false;
+        }
+
+        selectVariation(selectedVariation + step);
+        PrintMessage("Selected variation " + std::to_string(selectedVariation + 1) +
+                     "/" + std::to_string(variationBank.hits.size(0)));
+        return true;
+    }
+
+    // compares the cost of num_variations single calls of sample() with one batched call
+    void benchmarkVariationBank() {
+        torch::NoGradGuard no_grad;
+        auto params = currentSamplingParams();
+        samplePattern(*backend, torch::randn({ 1, 128}), params);     // warm up
+
+        chrono_timer single_calls;
+        single_calls.registerStartTime();
+        for (int i = 0; i < num_variations; i++) {
+            samplePattern(*backend, torch::randn({ 1, 128}), params);
+        }
+        single_calls.registerEndTime();
+
+        chrono_timer batched_call;
+        batched_call.registerStartTime();
+        samplePattern(*backend, torch::randn({ num_variations, 128}), params);
+        batched_call.registerEndTime();
+
+        std::stringstream ss;
+        ss << "Variation bank benchmark (" << num_variations << " variations):" << std::endl;
+        ss << *single_calls.getDescription(" | single calls: ") << std::endl;
+        ss << *batched_call.getDescription(" | batched call: ");
+        PrintMessage(ss.str());
+    }
+
+    // picks the fastest thread count for encode + sample (cached next to the presets)
+    void tuneNumThreads() {
+        auto fingerprint = ThreadCountTuner::makeFingerprint(model_path);
+        num_inference_threads = ThreadCountTuner::loadCachedChoice(fingerprint);
+
+        if (!num_inference_threads.has_value()) {
+            PrintMessage("Tuning the number of inference threads...");
+            torch::NoGradGuard no_grad;
+            auto groove = torch::zeros({1, groove_steps, groove_channels}, torch::kFloat32);
+            auto params = currentSamplingParams();
+            num_inference_threads = ThreadCountTuner::tune(
+                fingerprint,
+                [&]() {
+                    encodeLatent(*backend, groove, density);
+                    samplePattern(*backend, torch::randn({ num_variations, 128}), params);
+                },
+                [&](int num_threads) { backend->setNumThreads(num_threads); });
+        }
+
+        for (auto& [type, b] : backends) {
+            if (b != nullptr) { b->setNumThreads(*num_inference_threads); }
+        }
+        PrintMessage("Using " + std::to_string(*num_inference_threads) + " inference thread(s)");
+    }
+
+    static BackendType backendTypeFromText(const std::string &text) {
+        if (text == "TorchScript int8") { return BackendType::TorchScriptInt8; }
+        if (text == "ONNX Runtime fp32") { return BackendType::OnnxRuntime; }
+        if (text == "TorchScript out-of-process") { return BackendType::OutOfProcess; }
+        return BackendType::TorchScriptFp32;
+    }
+
+    // returns the requested backend (loading it if needed), nullptr if not available
+    std::shared_ptr<InferenceBackend> getBackend(BackendType type) {
+        auto it = backends.find(type);
+        if (it != backends.end()) {
+            return it->second;
+        }
+
+        auto memory_before = getResidentMemoryKB();
+        std::shared_ptr<InferenceBackend> newBackend;
+        if (type == BackendType::TorchScriptFp32) {
+            newBackend = std::make_shared<TorchScriptBackend>(model, "TorchScript fp32");
+        } else if (type == BackendType::TorchScriptInt8) {
+            if (auto module = loadAuxiliaryModel(quantized_model_name)) {
+                newBackend = std::make_shared<TorchScriptBackend>(*module, "TorchScript int8");
+            }
+        } else if (type == BackendType::OutOfProcess) {
+            auto host_path = getDefaultInferenceHostPath();
+            if (host_path.empty()) {
+                PrintMessage("Out-of-process backend not available (built without NMFX_BUILD_INFERENCE_HOST)");
+            } else {
+                newBackend = createOutOfProcessBackend(host_path);
+                if (!newBackend->load(model_path)) {
+                    newBackend = nullptr;
+                }
+            }
+        } else {
+            newBackend = createOnnxRuntimeBackend();
+            if (newBackend == nullptr) {
+                PrintMessage("ONNX Runtime backend not available (built without NMFX_WITH_ONNXRUNTIME)");
+            } else if (!newBackend->load(getModelPath(onnx_model_name))) {
+                newBackend = nullptr;
+            }
+        }
+
+        if (newBackend != nullptr && num_inference_threads.has_value()) {
+            newBackend->setNumThreads(*num_inference_threads);
+        }
+
+        auto memory_after = getResidentMemoryKB();
+        backendLoadMemoryKB[type] = memory_after > memory_before ? memory_after - memory_before : 0;
+        backends[type] = newBackend;
+        return newBackend;
+    }
+
+    // selects the backend used for inference (falls back to TorchScript fp32 if not available)
+    // returns true if the selected backend has changed
+    bool selectBackend(BackendType type) {
+        auto requested = getBackend(type);
+        if (requested == nullptr) {
+            PrintMessage("Requested backend not available, using TorchScript fp32");
+            type = BackendType::TorchScriptFp32;
+            requested = getBackend(type);
+        }
+
+        if (type == selectedBackend) {
+            return false;
+        }
+
+        backend = requested;
+        selectedBackend = type;
+        PrintMessage("Using the " + backend->getName() + " backend");
+        return true;
+    }
+
+    // compares latency, memory and output divergence (w.r.t. TorchScript fp32) of all available backends
+    // on a fixed set of grooves. The grooves and latents are seeded, so results are comparable across machines
+    // (for the out-of-process backend, the time includes the round trips to the inference host, and its load
+    // memory only covers the plugin side, the model itself lives in the host process)
+    void compareBackends() {
+        torch::NoGradGuard no_grad;
+        constexpr int num_grooves = 16;
+        auto params = currentSamplingParams();
+
+        // fixed set of grooves (random hits on the closed hat channels of the hvo) and latents
+        // drawn from a local generator, reseeding the global one would make all later generations deterministic
+        auto generator = at::detail::createCPUGenerator(1234);
+        std::vector<torch::Tensor> grooves;
+        std::vector<torch::Tensor> latents;
+        for (int i = 0; i < num_grooves; i++) {
+            auto groove = torch::zeros({1, groove_steps, groove_channels}, torch::kFloat32);
+            auto groove_hits = torch::bernoulli(torch::full({1, groove_steps}, 0.4f), generator);
+            groove.index_put_({torch::indexing::Ellipsis, groove_hit_channel}, groove_hits);
+            groove.index_put_({torch::indexing::Ellipsis, groove_velocity_channel},
+                              groove_hits * torch::rand({1, groove_steps}, generator));
+            groove.index_put_({torch::indexing::Ellipsis, groove_offset_channel},
+                              groove_hits * (torch::rand({1, groove_steps}, generator) - 0.5f));
+            grooves.push_back(groove);
+            latents.push_back(torch::randn({1, 128}, generator));
+        }
+
+        auto run = [&](InferenceBackend &backend_, std::vector<GeneratedPattern> &outputs) {
+            backend_.warmUp("encode", {grooves[0], torch::tensor(density).unsqueeze_(0)});
+            chrono_timer timer;
+            timer.registerStartTime();
+            for (int i = 0; i < num_grooves; i++) {
+                encodeLatent(backend_, grooves[i], density);
+                outputs.push_back(samplePattern(backend_, latents[i], params));
+            }
+            timer.registerEndTime();
+            return timer;
+        };
+
+        std::vector<GeneratedPattern> reference_outputs;
+        run(*getBackend(BackendType::TorchScriptFp32), reference_outputs);
+
+        std::stringstream ss;
+        ss << "Inference backend comparison (" << num_grooves << " grooves, encode + sample):" << std::endl;
+
+        for (auto type : {BackendType::TorchScriptFp32, BackendType::TorchScriptInt8, BackendType::OnnxRuntime,
+                          BackendType::OutOfProcess}) {
+            auto candidate = getBackend(type);
+            if (candidate == nullptr) {
+                continue;
+            }
+
+            std::vector<GeneratedPattern> outputs;
+            auto timer = run(*candidate, outputs);
+
+            // sample() returns thresholded hits, so the divergence is reported as the ratio of hits that
+            // differ, plus the mean absolute velocity difference on the hits both backends agree on
+            double hit_disagreement = 0;
+            double velocity_error = 0;
+            for (int i = 0; i < num_grooves; i++) {
+                if (!reference_outputs[i].isValid() || !outputs[i].isValid()) {
+                    continue;   // failed calls are logged by the backend
+                }
+                auto h_ref = reference_outputs[i].hits > 0.5;
+                auto h = outputs[i].hits > 0.5;
+                hit_disagreement += (h_ref != h).to(torch::kFloat32).mean().item<double>();
+                auto both = (h_ref & h).to(torch::kFloat32);
+                auto num_both = both.sum().item<double>();
+                if (num_both > 0) {
+                    auto diff = (reference_outputs[i].velocities - outputs[i].velocities).abs() * both;
+                    velocity_error += diff.sum().item<double>() / num_both;
+                }
+            }
+
+            ss << candidate->getName() << *timer.getDescription(" | time: ")
+               << " | load memory: " << backendLoadMemoryKB[type] / 1024 << " MB"
+               << " | hit disagreement: " << 100.0 * hit_disagreement / num_grooves << " %"
+               << " | mean velocity error: " << velocity_error / num_grooves << std::endl;
+        }
+        ss << "Process resident memory: " << getResidentMemoryKB() / 1024 << " MB";
+        PrintMessage(ss.str());
+    }
+
+    // copies the sampling parameters so that they can be safely used in the background
+    SamplingParams currentSamplingParams() const {
+        return {voice_thresholds.clone(), max_counts_allowed.clone(), sampling_mode, temperature};
+    }
+
+    static int densityToBucket(float density_) {
+        return (int) std::lround(std::clamp(density_, 0.0f, 1.0f) * num_density_buckets);
+    }
+
+    // content hash of the quantized groove, the exact density and the sampling parameters
+    uint64_t generationInputsHash() const {
+        auto key = makePatternKey(0);
+        uint64_t h = hash_combine(key.groove_hash, key.thresholds_hash);
+        h = hash_bytes(&density, sizeof(density), h);
+        return hash_bytes(&temperature, sizeof(temperature), h);
+    }
+
+    PatternKey makePatternKey(int density_bucket) const {
+        auto thr = voice_thresholds.contiguous();
+        auto cnt = max_counts_allowed.contiguous();
+
+        PatternKey key;
+        key.groove_hash = hash_bytes(groove_hvo, sizeof(groove_hvo));
+        key.density_bucket = density_bucket;
+        key.temperature = temperature;
+        key.thresholds_hash = hash_bytes(cnt.data_ptr(), cnt.nbytes(),
+                                         hash_bytes(thr.data_ptr(), thr.nbytes()));
+        key.thresholds_hash = hash_combine(key.thresholds_hash, (uint64_t) sampling_mode);
+        key.thresholds_hash = hash_combine(key.thresholds_hash, (uint64_t) selectedBackend);
+        return key;
+    }
+
+    // tries to load the pattern for the quantized density of the current groove from the cache
+    // returns true if the pattern was available
+    bool loadPatternFromVariationCache() {
+        auto cached = variationCache.get(makePatternKey(densityToBucket(density)));
+        if (!cached.has_value()) {
+            return false;
+        }
+
+        setVariationBank(*cached);
+        return true;
+    }
+
+    // queues background generation of the patterns for the buckets around the current density
+    void requestSpeculativePatterns() {
+        auto jobBackend = backend;
+        auto params = currentSamplingParams();
+
+        std::vector<SpeculativeJobThread::Job> jobs;
+
+        // closest buckets first
+        auto centre = densityToBucket(density);
+        std::vector<int> buckets {centre};
+        for (int distance = 1; distance <= num_speculated_neighbours; distance++) {
+            buckets.push_back(centre - distance);
+            buckets.push_back(centre + distance);
+        }
+
+        for (auto bucket : buckets) {
+            if (bucket < 0 || bucket > num_density_buckets) { continue; }
+
+            auto key = makePatternKey(bucket);
+            if (variationCache.contains(key)) { continue; }
+
+            jobs.emplace_back([this, jobBackend, params, key]() {
+                if (variationCache.contains(key)) { return; }
+                auto pattern = generateDetached(jobBackend, params);
+                if (pattern.isValid()) {
+                    variationCache.put(key, pattern);
+                }
+            });
+        }
+
+        speculativeJobs.submit(std::move(jobs));
     }
 
     // extracts the generated pattern into a PlaybackSequence
@@ -240,28 +877,44 @@ private:
             // clear playback sequence
             playbackSequence.clear();
 
-            // iterate through all voices, and time steps
-            int batch_ix = 0;
-            for (int step_ix = 0; step_ix < 32; step_ix++)
-            {
-                for (int voice_ix = 0; voice_ix < 9; voice_ix++)
-                {
-
-                    // check if the voice is active at this time step
-                    if (hits[batch_ix][step_ix][voice_ix].item<float>() > 0.5)
-                    {
-                        auto midi_num = voiceMap[voice_ix];
-                        auto velocity = velocities[batch_ix][step_ix][voice_ix].item<float>();
-                        auto offset = offsets[batch_ix][step_ix][voice_ix].item<float>();
-                        // we are going to convert the onset time to a ratio of quarter notes
-                        auto time = (step_ix + offset) * 0.25f;
-
-                        playbackSequence.addNoteWithDuration(
-                            0, midi_num, velocity, time, 0.1f);
-
-                    }
-                }
+            // read the first batch item directly from contiguous memory
+            // (avoids an ATen dispatch per cell)
+            auto h = hits[0].to(torch::kFloat32).contiguous();
+            auto v = velocities[0].to(torch::kFloat32).contiguous();
+            auto o = offsets[0].to(torch::kFloat32).contiguous();
+            const float* h_ptr = h.data_ptr<float>();
+            const float* v_ptr = v.data_ptr<float>();
+            const float* o_ptr = o.data_ptr<float>();
+
+            // threshold all (step, voice) cells in one branch-free pass (vectorized by the compiler)
+            constexpr int num_voices = 9;
+            constexpr int num_cells = groove_steps * num_voices;
+            uint8_t active[num_cells];
+            for (int i = 0; i < num_cells; i++) {
+                active[i] = h_ptr[i] > 0.5f;
             }
+
+            // compact list of the active hits
+            std::vector<paired_note> notes;
+            notes.reserve(num_cells);
+            for (int i = 0; i < num_cells; i++) {
+                if (!active[i]) { continue; }
+
+                auto step_ix = i / num_voices;
+                auto voice_ix = i % num_voices;
+
+                paired_note note;
+                note.noteOn.channel = 0;
+                note.noteOn.noteNumber = voiceMap[voice_ix];
+                note.noteOn.velocity = v_ptr[i];
+                // we are going to convert the onset time to a ratio of quarter notes
+                note.noteOn.time = (step_ix + o_ptr[i]) * 0.25f;
+                note.duration = 0.1f;
+                notes.push_back(note);
+            }
+
+            // build the sequence in bulk (single sort and note on/off matching pass)
+            playbackSequence.addNotesWithDuration(notes);
         }
     }
 
@@ -274,4 +927,7 @@ private:
         playbackPolicy.ActivateLooping(8);
     }
 
+    // background thread used for the variation cache
+    // (declared last, so that it is stopped before any of the data used by its jobs is destroyed)
+    SpeculativeJobThread speculativeJobs;
 };
\ No newline at end of file
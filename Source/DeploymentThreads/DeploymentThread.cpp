@@ -76,6 +76,7 @@ void DeploymentThread::run() {
 
         } else {
             gui_params.setChanged(false); // no change in parameters since last check
+            gui_params.setPresetApplied(false);
         }
 
         if (NMP2DPL_Event_Que_ptr->getNumReady() > 0) {
@@ -123,9 +124,13 @@ void DeploymentThread::run() {
 
         // scope lock mutex deploymentThread->preset_loaded_mutex
         // try to lock mutex, if not possible, skip the rest of the loop
-        bool newPresAvail = CustomPresetData->hasTensorDataChanged();
+        // (a preset's parameters and data arrive together, see APVTSMediatorThread::apply_preset)
+        bool newPresAvail = CustomPresetData->hasTensorDataChanged() || gui_params.wasPresetApplied();
 
-        if (new_event_from_DAW.has_value() || gui_params.changed() || newPresAvail || midiFileDroppedOnVisualizer || audioFileDroppedOnVisualizer) {
+        // check if deploy() was explicitly requested (i.e. by a background job)
+        bool deployRequested = deployCallRequested.exchange(false);
+
+        if (new_event_from_DAW.has_value() || gui_params.changed() || newPresAvail || midiFileDroppedOnVisualizer || audioFileDroppedOnVisualizer || deployRequested) {
             new_midi_event_dropped_manually = std::nullopt;
             chrono_timed_deploy.registerStartTime();
             auto status = deploy(
@@ -147,7 +152,7 @@ void DeploymentThread::run() {
 
             if (shouldSendNewPlaybackSequence) {
                 // send to the main thread (NMP)
-                DPL2NMP_GenerationEvent_Que_ptr->push(GenerationEvent(playbackSequence));
+                DPL2NMP_GenerationEvent_Que_ptr->push(GenerationEvent(std::move(playbackSequence)));
                 cnt++;
             }
 
@@ -192,7 +197,7 @@ void DeploymentThread::run() {
 
                     if (shouldSendNewPlaybackSequence) {
                         // send to the main thread (NMP)
-                        DPL2NMP_GenerationEvent_Que_ptr->push(GenerationEvent(playbackSequence));
+                        DPL2NMP_GenerationEvent_Que_ptr->push(GenerationEvent(std::move(playbackSequence)));
                         cnt++;
                     }
 
@@ -277,9 +282,7 @@ bool DeploymentThread::load(const std::string& model_name_)
 {
 
     // Creates the path depending on the OS
-    std::string model_path_ = stripQuotes(std::string(MDL_path::default_model_path)) +
-                              std::string(MDL_path::path_separator) +
-                              model_name_;
+    std::string model_path_ = getModelPath(model_name_);
 
 
     // If already tried the path, don't try again
@@ -309,6 +312,29 @@ bool DeploymentThread::load(const std::string& model_name_)
     }
 }
 
+std::string DeploymentThread::getModelPath(const std::string& model_name_)
+{
+    return stripQuotes(std::string(MDL_path::default_model_path)) +
+           std::string(MDL_path::path_separator) +
+           model_name_;
+}
+
+std::optional<torch::jit::script::Module> DeploymentThread::loadAuxiliaryModel(const std::string& model_name_)
+{
+    auto path = getModelPath(model_name_);
+
+    ifstream myFile;
+    myFile.open(path);
+    if (myFile.is_open()) {
+        myFile.close();
+        cout << "Auxiliary model file found at: " + path << " -- Trying to load model..." << endl;
+        return torch::jit::load(path);
+    } else {
+        cout << "Auxiliary model file not found at: " + path << endl;
+        return std::nullopt;
+    }
+}
+
 [[maybe_unused]] void DeploymentThread::DisplayTensor(const torch::Tensor &tensor, const string& Label,
                                      bool display_content=false){
 
@@ -90,7 +90,7 @@ protected:
 
     // Playback 1_RandomGeneration Data
     PlaybackPolicies playbackPolicy;
-    PlaybackSequence playbackSequence;
+    PlaybackSequence playbackSequence;  // handed off (moved) to the plugin when sent, so it is empty afterwards
 
 
     // ============================================================================================================
@@ -115,6 +115,33 @@ protected:
     static void DisplayEvent(const EventFromHost&event, bool compact_mode, double event_count);
     static void PrintMessage(const std::string &input);
 
+    // ============================================================================================================
+    // ===          Deferred Deploy Requests
+    // ===  (can be called from any thread, i.e. a helper thread that finished a background job.
+    // ===   deploy() will be called in the next iteration even if no new event/parameter is available)
+    // ============================================================================================================
+    void requestDeployCall() { deployCallRequested = true; }
+
+    // ============================================================================================================
+    // ===          Note Remapping
+    // ===  (remaps the notes of the stream currently played by the plugin without resending it,
+    // ===   call from deploy() only)
+    // ============================================================================================================
+    void sendNoteRemap(const NoteRemapTable& table) {
+        DPL2NMP_GenerationEvent_Que_ptr->push(GenerationEvent(table));
+    }
+
+    // ============================================================================================================
+    // ===          Incremental Stream Edits
+    // ===  (inserts/removes/replaces events of the stream currently played by the plugin, without resending it.
+    // ===   times follow the last sent PlaybackPolicies, call from deploy() only)
+    // ============================================================================================================
+    void sendPlaybackSequenceEdit(PlaybackSequenceEdit edit) {
+        if (!edit.isEmpty()) {
+            DPL2NMP_GenerationEvent_Que_ptr->push(GenerationEvent(std::move(edit)));
+        }
+    }
+
     // ============================================================================================================
     // ===          User Customizable Struct
     // ============================================================================================================
@@ -128,8 +155,15 @@ protected:
     bool isModelLoaded{false};
     bool load(const std::string& model_name_);
     std::string model_path;
+    // loads an additional model (i.e. a quantized variant) without replacing `model`
+    // returns nullopt if the file is not available
+    static std::optional<torch::jit::script::Module> loadAuxiliaryModel(const std::string& model_name_);
+    static std::string getModelPath(const std::string& model_name_);
     void DisplayTensor(const torch::Tensor &tensor, const string& Label,
                        bool display_content);
+
+private:
+    std::atomic<bool> deployCallRequested{false};
 };
 
 
@@ -7,133 +7,40 @@
 #include "shared_plugin_helpers/shared_plugin_helpers.h"
 #include "GuiParameters.h"
 #include "LockFreeQueue.h"
+#include "PresetLoaderThread.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
 
 #pragma once
 
 
+// compiled in from settings.json (see generated_settings::parameters), no json is parsed here
 inline std::vector<juce::ParameterID> get_preset_excluded_params() {
     std::vector<std::string> excluded_params;
-    auto loaded_json_ = load_settings_json();
-    for (const auto& tabJson: loaded_json_["UI"]["Tabs"]["tabList"])
-    {
-        if (tabJson.contains("sliders")) {
-            for (const auto& sliderJson: tabJson["sliders"])
-            {
-                if (sliderJson.contains("exclude_from_presets"))
-                {
-                    if (sliderJson["exclude_from_presets"].get<bool>())
-                    {
-                        excluded_params.push_back(sliderJson["label"].get<std::string>());
-                    }
-                }
-            }
-        }
-
-        if (tabJson.contains("rotaries")) {
-            for (const auto& rotaryJson: tabJson["rotaries"])
-            {
-                if (rotaryJson.contains("exclude_from_presets"))
-                {
-                    if (rotaryJson["exclude_from_presets"].get<bool>())
-                    {
-                        excluded_params.push_back(rotaryJson["label"].get<std::string>());
-                    }
-                }
-            }
-        }
-
-        if (tabJson.contains("buttons")) {
-            for (const auto& buttonJson: tabJson["buttons"])
-            {
-                if (buttonJson.contains("exclude_from_presets"))
-                {
-                    if (buttonJson["exclude_from_presets"].get<bool>())
-                    {
-                        excluded_params.push_back(buttonJson["label"].get<std::string>());
-                    }
-                }
-            }
-        }
-
-        if (tabJson.contains("hsliders")) {
-            for (const auto& hsliderJson: tabJson["hsliders"])
-            {
-                if (hsliderJson.contains("exclude_from_presets"))
-                {
-                    if (hsliderJson["exclude_from_presets"].get<bool>())
-                    {
-                        excluded_params.push_back(hsliderJson["label"].get<std::string>());
-                    }
-                }
-            }
-        }
-
-        if (tabJson.contains("comboBoxes")) {
-            for (const auto& comboBoxJson: tabJson["comboBoxes"])
-            {
-                if (comboBoxJson.contains("exclude_from_presets"))
-                {
-                    if (comboBoxJson["exclude_from_presets"].get<bool>())
-                    {
-                        excluded_params.push_back(
-                                comboBoxJson["label"].get<std::string>());
-                    }
-                }
-            }
-        }
-
-        if (tabJson.contains("MidiDisplays")) {
-            for (const auto& midiDisplayJson: tabJson["MidiDisplays"])
-            {
-                if (midiDisplayJson.contains("exclude_from_presets"))
-                {
-                    if (midiDisplayJson["exclude_from_presets"].get<bool>())
-                    {
-                        excluded_params.push_back(
-                                midiDisplayJson["label"].get<std::string>());
-                    }
-                }
-            }
-        }
-
-        if (tabJson.contains("AudioDisplays")) {
-            for (const auto& audioDisplayJson: tabJson["AudioDisplays"])
-            {
-                if (audioDisplayJson.contains("exclude_from_presets"))
-                {
-                    if (audioDisplayJson["exclude_from_presets"].get<bool>())
-                    {
-                        excluded_params.push_back(
-                                audioDisplayJson["label"].get<std::string>());
-                    }
-                }
-            }
+    for (const auto& descriptor : generated_settings::parameters) {
+        if (descriptor.exclude_from_presets) {
+            excluded_params.emplace_back(descriptor.label);
         }
     }
 
-    if (loaded_json_["StandaloneTransportPanel"].contains("exclude_tempo_from_presets")) {
-        if (loaded_json_["StandaloneTransportPanel"]["exclude_tempo_from_presets"].get<bool>()) {
-            excluded_params.emplace_back("TempoStandalone");
-        }
+    using namespace generated_settings::StandaloneTransportPanel;
+    if (exclude_tempo_from_presets) {
+        excluded_params.emplace_back("TempoStandalone");
     }
 
-    if (loaded_json_["StandaloneTransportPanel"].contains("exclude_time_signature_from_presets")) {
-        if (loaded_json_["StandaloneTransportPanel"]["exclude_time_signature_from_presets"].get<bool>()) {
-            excluded_params.emplace_back("TimeSigNumeratorStandalone");
-            excluded_params.emplace_back("TimeSigDenominatorStandalone");
-        }
+    if (exclude_time_signature_from_presets) {
+        excluded_params.emplace_back("TimeSigNumeratorStandalone");
+        excluded_params.emplace_back("TimeSigDenominatorStandalone");
     }
 
-    if (loaded_json_["StandaloneTransportPanel"].contains("exclude_play_button_from_presets")) {
-        if (loaded_json_["StandaloneTransportPanel"]["exclude_play_button_from_presets"].get<bool>()) {
-            excluded_params.emplace_back("IsPlayingStandalone");
-        }
+    if (exclude_play_button_from_presets) {
+        excluded_params.emplace_back("IsPlayingStandalone");
     }
 
-    if (loaded_json_["StandaloneTransportPanel"].contains("exclude_record_button_from_presets")) {
-        if (loaded_json_["StandaloneTransportPanel"]["exclude_record_button_from_presets"].get<bool>()) {
-            excluded_params.emplace_back("IsRecordingStandalone");
-        }
+    if (exclude_record_button_from_presets) {
+        excluded_params.emplace_back("IsRecordingStandalone");
     }
 
     // parse using label2ParamID
@@ -190,6 +97,10 @@ public:
         guiParamsPntr = make_unique<GuiParams>(APVTSPntr_);
         APVM2DPL_GuiParams_QuePntr->push(*guiParamsPntr);
 
+        auto presetRange = APVTSPntr->getParameterRange(label2ParamID("Preset"));
+        presetLoader = make_unique<PresetLoaderThread>(
+            APVTSPntr->state.getType(), (int) presetRange.start, (int) presetRange.end);
+
         startThread();
     }
 
@@ -214,13 +125,26 @@ public:
 
                 // check if selected preset has changed
                 auto selectedPreset = (int) *APVTSPntr->getRawParameterValue(label2ParamID("Preset"));
-                if (selectedPreset != prev_selectedPreset) {
+                auto restored = restoredPreset.load();
+                if (restored != no_restored_preset) {
+                    // a restored session state is being applied, its preset is not reloaded from disk
+                    if (selectedPreset == restored) {
+                        prev_selectedPreset = selectedPreset;
+                        restoredPreset.compare_exchange_strong(restored, no_restored_preset);
+                    }
+                } else if (selectedPreset != prev_selectedPreset) {
                     // if selected preset has changed, send a message to the deployment thread
                     // to load the new preset
                     prev_selectedPreset = selectedPreset;
 
-                    load_preset(selectedPreset);
+                    // loaded in the background, applied below once ready
+                    presetLoader->request(selectedPreset);
+                }
 
+                if (restoredPreset == no_restored_preset) {
+                    if (auto preset = presetLoader->takeLoaded()) {
+                        apply_preset(*preset);
+                    }
                 }
 
                 bExit = threadShouldExit();
@@ -233,44 +157,63 @@ public:
 
     }
     // ============================================================================================================
-    void load_preset(const int preset_idx) {
-        // XML file paths
-        std::string fp = stripQuotes(default_preset_dir) + path_separator + std::to_string(preset_idx) + ".apvts";
-        std::string fp_data = stripQuotes(default_preset_dir) + path_separator + std::to_string(preset_idx) + ".preset_data";
-
-        // Step 1: Read the XML from the file
-        auto xml = juce::XmlDocument::parse(juce::File(fp));
-
-        // Step 2: Get the ValueTree from the XML
-        if (xml != nullptr)
-        {
-            if (xml->hasTagName(APVTSPntr->state.getType()))
-            {
-                // 3.a get the existing values of the parameters that are not to be loaded
-                std::vector<float> values_not_to_load;
-                for (const auto& paramID: paramIDs2Exclude) {
-                    values_not_to_load.emplace_back(APVTSPntr->getParameter(paramID.getParamID())->getValue());
-                }
+    // called (from the message thread) before a state restored by the host is applied, so that the preset
+    // selected in that state doesn't overwrite the restored parameters and preset data
+    void adoptRestoredState(int selected_preset) {
+        restoredPreset = selected_preset;
+        if (presetLoader != nullptr) {
+            presetLoader->cancel();
+        }
+    }
 
-                // 3.b load the preset and reset the APVTS with the new preset
-                APVTSPntr->replaceState(juce::ValueTree::fromXml(*xml));
+    // ============================================================================================================
+    // applies a preset loaded by the PresetLoaderThread
+    // only the parameters that differ from the preset are set (excluded ones and the preset selection itself are
+    // left untouched), and the DPL receives the parameters and the preset data as a single update
+    void apply_preset(const PresetLoaderThread::LoadedPreset& preset) {
+        // 1. diff the current values against the preset (values in the state are denormalized)
+        std::vector<std::pair<juce::RangedAudioParameter*, float>> changes;
+        for (const auto& child : preset.state) {
+            auto paramID = child.getProperty("id").toString();
+            if (paramID == juce::String(label2ParamID("Preset")) || isExcludedFromPresets(paramID)) {
+                continue;
+            }
+            auto parameter = APVTSPntr->getParameter(paramID);
+            if (parameter == nullptr || !child.hasProperty("value")) {
+                continue;
+            }
+            auto value = parameter->convertTo0to1((float) child.getProperty("value"));
+            if (std::abs(value - parameter->getValue()) > 1e-6f) {
+                changes.emplace_back(parameter, value);
+            }
+        }
 
-                // 3.c use the values in 3.a to reset the parameters that are not to be loaded
-                // We store all params in APVTS but just loading it when needed
-                for (int i = 0; i < paramIDs2Exclude.size(); i++) {
-                    APVTSPntr->getParameter(paramIDs2Exclude[i].getParamID())->setValueNotifyingHost(values_not_to_load[i]);
-                }
+        // 2. hold back the preset data notification until the parameters are pushed along with it
+        CustomPresetData->beginUpdate();
+        CustomPresetData->copy_from_map(preset.tensors);
+        if (debugging_settings::APVTSMediatorThread::print_loaded_preset_data) {
+            CustomPresetData->printTensorMap();
+        }
 
-                // 4. load the tensor preset data associated with the preset
-                auto filePath = xml->getStringAttribute("filePath");
-                auto tensormap = load_tensor_map(filePath.toStdString());
-                CustomPresetData->copy_from_map(tensormap);
-                CustomPresetData->printTensorMap();
-            }
+        // 3. apply the changes as one gesture, so that the host records a single edit
+        for (auto& [parameter, value] : changes) { parameter->beginChangeGesture(); }
+        for (auto& [parameter, value] : changes) { parameter->setValueNotifyingHost(value); }
+        for (auto& [parameter, value] : changes) { parameter->endChangeGesture(); }
 
+        // 4. a single coalesced push (instead of the changes trickling in through the polling)
+        guiParamsPntr->update();
+        guiParamsPntr->setPresetApplied(true);
+        if (APVM2DPL_GuiParams_QuePntr != nullptr) {
+            APVM2DPL_GuiParams_QuePntr->push(*guiParamsPntr);
         }
+        guiParamsPntr->setPresetApplied(false);
+        CustomPresetData->endUpdate();
+    }
 
-}
+    [[nodiscard]] bool isExcludedFromPresets(const juce::String& paramID) const {
+        return std::any_of(paramIDs2Exclude.begin(), paramIDs2Exclude.end(),
+                           [&](const auto& excluded) { return excluded.getParamID() == paramID; });
+    }
 
     // ============================================================================================================
     // ===          Preparing Thread for Stopping
@@ -279,6 +222,9 @@ public:
 
     // run this in destructor destructing object
     void prepareToStop() {
+        if (presetLoader != nullptr) {
+            presetLoader->prepareToStop();
+        }
         //Need to wait enough to ensure the run() method is over before killing thread
         this->stopThread(int(100 * thread_configurations::APVTSMediatorThread::waitTimeBtnIters));
         readyToStop = true;
@@ -293,6 +239,9 @@ public:
 private:
     CustomPresetDataDictionary *CustomPresetData;
 
+    static constexpr int no_restored_preset = std::numeric_limits<int>::min();
+    std::atomic<int> restoredPreset{no_restored_preset};
+
     // ============================================================================================================
     // ===          Output Queues for Receiving/Sending Data
     // ============================================================================================================
@@ -310,4 +259,9 @@ private:
     // ============================================================================================================
     std::vector<ParameterID> paramIDs2Exclude {get_preset_excluded_params()};
 
+    // ============================================================================================================
+    // ===          Background Preset Loading (LRU cache + prefetch of the neighbouring presets)
+    // ============================================================================================================
+    unique_ptr<PresetLoaderThread> presetLoader;
+
 };
@@ -6,6 +6,7 @@
 
 #include <torch/script.h> // One-stop header.
 #include "json.hpp"
+#include "GeneratedSettings.h"      // generated from settings.json at configure time
 
 using json = nlohmann::json;
 
@@ -48,28 +49,32 @@ using tab_tuple = std::tuple<
     comboBox_list, midiDisplay_list, audioDisplay_list, labels_list,
     lines_list, triangleSliders_list>;
 
+// settings.json is compiled in at build time (see CMake/GenerateSettingsHeader.cmake), so loading the plugin
+// (i.e. during host plugin scans) doesn't read it from disk. The flags below, the parameter layout, GuiParams and
+// the preset exclusions don't need it at all (see generated_settings), only the tab layout of the editor does
 inline json load_settings_json() {
 
-    std::string filePath = DEFAULT_SETTINGS_FILE_PATH;  // Use the predefined macro
-
-     std::ifstream file(filePath);
-     if (!file.is_open()) {
-         std::cerr << "Error opening JSON file: " << filePath << std::endl;
-         throw std::runtime_error("Failed to open JSON file");
+     std::string text;
+     for (const auto* chunk : generated_settings::settings_json_chunks) {
+         text += chunk;
      }
 
      json j;
      try {
-         file >> j;
+         j = json::parse(text);
      } catch (const std::exception& e) {
-         std::cerr << "Error parsing JSON file: " << e.what() << std::endl;
+         std::cerr << "Error parsing the embedded settings.json: " << e.what() << std::endl;
          throw;
      }
 
      return j;
 }
 
-inline json loaded_json = load_settings_json();
+// parsed the first time it is needed (i.e. when the editor is first opened), never during static initialization
+inline const json& getLoadedJson() {
+    static const json loaded_json = load_settings_json();
+    return loaded_json;
+}
 
 // ---------------------------------------------------------------------------------
 inline std::vector<tab_tuple> parse_to_tabList() {
@@ -77,7 +82,7 @@ inline std::vector<tab_tuple> parse_to_tabList() {
     std::vector<tab_tuple> tabList;
 
     // check if tabList exists
-    auto tabs_json = loaded_json["UI"]["Tabs"];
+    const auto& tabs_json = getLoadedJson()["UI"]["Tabs"];
 
 
     for (const auto& tabJson: tabs_json["tabList"]) {
@@ -165,39 +170,45 @@ inline std::vector<tab_tuple> parse_to_tabList() {
 }
 
 // GUI settings
+// (generated from the "UI", "StandaloneTransportPanel" and "VirtualMidiOut" sections into GeneratedSettings.h)
 namespace UIObjects {
 
-    const bool user_resizable = loaded_json["UI"].contains("resizable") ? loaded_json["UI"]["resizable"].get<bool>() : false;
-    const bool user_maintain_aspect_ratio = loaded_json["UI"].contains("maintain_aspect_ratio") ? loaded_json["UI"]["maintain_aspect_ratio"].get<bool>() : false;
-    const int user_width = loaded_json["UI"].contains("width") ? loaded_json["UI"]["width"].get<int>() : 800;
-    const int user_height = loaded_json["UI"].contains("height") ? loaded_json["UI"]["height"].get<int>() : 600;
+    constexpr bool user_resizable = generated_settings::UI::resizable;
+    constexpr bool user_maintain_aspect_ratio = generated_settings::UI::maintain_aspect_ratio;
+    constexpr int user_width = generated_settings::UI::width;
+    constexpr int user_height = generated_settings::UI::height;
 
     namespace Tabs {
-        const bool show_grid = loaded_json["UI"]["Tabs"]["show_grid"];
-        const bool draw_borders_for_components = loaded_json["UI"]["Tabs"]["draw_borders_for_components"];
-        const std::vector<tab_tuple> tabList = parse_to_tabList();
+        constexpr bool show_grid = generated_settings::Tabs::show_grid;
+        constexpr bool draw_borders_for_components = generated_settings::Tabs::draw_borders_for_components;
+
+        // widgets of each tab, only needed to lay out the editor (parses the json on first use)
+        inline const std::vector<tab_tuple>& getTabList() {
+            static const std::vector<tab_tuple> tabList = parse_to_tabList();
+            return tabList;
+        }
     }
 
     namespace MidiInVisualizer {
         // if you need the widget used for visualizing midi notes coming from host
         // set following to true
-        const bool enable = loaded_json["UI"]["MidiInVisualizer"]["enable"];
+        constexpr bool enable = generated_settings::MidiInVisualizer::enable;
 
         // if you want to allow user to drag/drop midi files into the plugin
         // set following to true
         // If active, the content of the midi file will be visualized in the
         // MidiInVisualizer and also be provided to you in the DeploymentThread
-        const bool allowToDragInMidi = loaded_json["UI"]["MidiInVisualizer"]["allowToDragInMidi"];
+        constexpr bool allowToDragInMidi = generated_settings::MidiInVisualizer::allowToDragInMidi;
 
         // if you want to visualize notes received in real-time from host
         // set following to true
-        const bool visualizeIncomingMidiFromHost = loaded_json["UI"]["MidiInVisualizer"]["visualizeIncomingMidiFromHost"];
+        constexpr bool visualizeIncomingMidiFromHost = generated_settings::MidiInVisualizer::visualizeIncomingMidiFromHost;
         // if playhead is manually moved backward, do you want to delete all the
         // previously visualized notes received from host?
-        const bool deletePreviousIncomingMidiMessagesOnBackwardPlayhead = loaded_json["UI"]["MidiInVisualizer"]["deletePreviousIncomingMidiMessagesOnBackwardPlayhead"];
+        constexpr bool deletePreviousIncomingMidiMessagesOnBackwardPlayhead = generated_settings::MidiInVisualizer::deletePreviousIncomingMidiMessagesOnBackwardPlayhead;
         // if playback is stopped, do you want to delete all the previously
         // visualized notes received from host?
-        const bool deletePreviousIncomingMidiMessagesOnRestart = loaded_json["UI"]["MidiInVisualizer"]["deletePreviousIncomingMidiMessagesOnRestart"];
+        constexpr bool deletePreviousIncomingMidiMessagesOnRestart = generated_settings::MidiInVisualizer::deletePreviousIncomingMidiMessagesOnRestart;
     }
 
     namespace GeneratedContentVisualizer
@@ -207,23 +218,23 @@ namespace UIObjects {
         // The content here visualizes the playbackSequence as it is at any given time
         // (remember that playbackSequence can be changed by the user within the
         // PlaybackPreparatorThread)
-        const bool enable = loaded_json["UI"]["GeneratedContentVisualizer"]["enable"];
+        constexpr bool enable = generated_settings::GeneratedContentVisualizer::enable;
 
         // if you want to allow the user to drag out the visualized content,
         // set following to true
-        const bool allowToDragOutAsMidi = loaded_json["UI"]["GeneratedContentVisualizer"]["allowToDragOutAsMidi"];
+        constexpr bool allowToDragOutAsMidi = generated_settings::GeneratedContentVisualizer::allowToDragOutAsMidi;
     }
 
     namespace StandaloneTransportPanel
     {
         // if you need the widget used for controlling the standalone transport
         // set following to true
-        const bool enable = loaded_json["StandaloneTransportPanel"]["enable"];
-        const bool disableInPluginMode = loaded_json["StandaloneTransportPanel"]["disableInPluginMode"];
+        constexpr bool enable = generated_settings::StandaloneTransportPanel::enable;
+        constexpr bool disableInPluginMode = generated_settings::StandaloneTransportPanel::disableInPluginMode;
         // if you need to send midi out to a virtual midi cable
         // set following to true
         // NOTE: Only works on MacOs
-        const bool NeedVirtualMidiOutCable = loaded_json["VirtualMidiOut"]["enable"];
+        constexpr bool NeedVirtualMidiOutCable = generated_settings::VirtualMidiOut::enable;
     }
 
 
@@ -272,52 +283,35 @@ namespace UIObjects {
  *      >>  constexpr bool FilterCCEvents_FLAG{false};
  *
  */
-namespace event_communication_settings {
-// set to true, if you need to send the metadata for a new buffer to the DPL thread
-const bool SendEventAtBeginningOfNewBuffers_FLAG{
-    loaded_json["event_communication_settings"]["SendEventAtBeginningOfNewBuffers_FLAG"]};
-const bool SendEventForNewBufferIfMetadataChanged_FLAG{
-    loaded_json["event_communication_settings"]["SendEventForNewBufferIfMetadataChanged_FLAG"]
-};     // only sends if metadata changes
-
-// set to true if you need to notify the beginning of a new bar
-const bool SendNewBarEvents_FLAG{
-    loaded_json["event_communication_settings"]["SendNewBarEvents_FLAG"]};
-
-// set to true EventFromHost for every time_shift_event ratio of quarter notes
-const bool SendTimeShiftEvents_FLAG{
-    loaded_json["event_communication_settings"]["SendTimeShiftEvents_FLAG"]};
-const double delta_TimeShiftEventRatioOfQuarterNote{
-    loaded_json["event_communication_settings"]["delta_TimeShiftEventRatioOfQuarterNote"]
-}; // sends a time shift event every 8th note
-
-// Filter Note On Events if you don't need them
-const bool FilterNoteOnEvents_FLAG{
-    loaded_json["event_communication_settings"]["FilterNoteOnEvents_FLAG"]};
-
-// Filter Note Off Events if you don't need them
-const bool FilterNoteOffEvents_FLAG{
-    loaded_json["event_communication_settings"]["FilterNoteOffEvents_FLAG"]};
-
-// Filter CC Events if you don't need them
-const bool FilterCCEvents_FLAG{
-    loaded_json["event_communication_settings"]["FilterCCEvents_FLAG"]};
-};
+// the flags (event_communication_settings::SendEventAtBeginningOfNewBuffers_FLAG, ...) are constexpr, generated
+// from the "event_communication_settings" section of settings.json into GeneratedSettings.h
 
 
 // ======================================================================================
 // ==================       Thread  Settings                  ============================
 // ======================================================================================
-namespace thread_configurations::SingleMidiThread {
-// wait time between iterations in ms
-const double waitTimeBtnIters{
-    loaded_json["deploy_method_min_wait_time_between_iterations"]};
-}
+// thread_configurations::SingleMidiThread::waitTimeBtnIters (deploy_method_min_wait_time_between_iterations in
+// settings.json) is generated into GeneratedSettings.h
 
 namespace thread_configurations::APVTSMediatorThread {
 // wait time between iterations in ms
 const double waitTimeBtnIters{1};
 }
+// ======================================================================================
+// ==================       Preset  Settings                  ============================
+// ======================================================================================
+// encoding of the tensors saved in .preset_data files (see preset_tensor_file in TorchScriptAndPresetLoaders.h)
+// preset_settings::compression_threshold_kb (-1: no compression), store_as_fp16 and compression_level (zlib,
+// 1: fastest ... 9: smallest) are generated from the "preset_settings" section into GeneratedSettings.h
+
+// ======================================================================================
+// ==================       Inference  Settings               ============================
+// ======================================================================================
+// inference_settings::auto_tune_num_threads_on_load (times 1..8 intra-op threads the first time a model is loaded
+// on a machine, see ThreadCountTuner.h) and inference_host_hang_timeout_ms (how long a call to the out-of-process
+// backend may take before the host is relaunched) are generated from the "inference_settings" section into
+// GeneratedSettings.h
+
 // ======================================================================================
 // ==================       QUEUE  Settings                  ============================
 // ======================================================================================
@@ -337,30 +331,6 @@ constexpr int APVM_que_size{4};    // same as APVM que size
 // ==============================================================================================
 // ==================       Debugging  Settings                  ================================
 // ==============================================================================================
-namespace debugging_settings::DeploymentThread {
-const bool print_received_gui_params{
-    loaded_json["debugging_settings"]["DeploymentThread"]["print_received_gui_params"]};                // print the received gui parameters
-const bool print_manually_dropped_midi_messages{
-    loaded_json["debugging_settings"]["DeploymentThread"]["print_manually_dropped_midi_messages"]
-};     // print the midi messages received from manually drag-dropped midi file
-const bool print_input_events{
-    loaded_json["debugging_settings"]["DeploymentThread"]["print_input_events"]};                        // print the input events
-const bool print_deploy_method_time{
-    loaded_json["debugging_settings"]["DeploymentThread"]["print_deploy_method_time"]};                    // print the time taken to deploy the model
-const bool disable_user_print_requests{
-    loaded_json["debugging_settings"]["DeploymentThread"]["disable_user_print_requests"]};                // disable all user requested prints
-}
-
-namespace debugging_settings::ProcessorThread {
-const bool print_start_stop_times{
-    loaded_json["debugging_settings"]["ProcessorThread"]["print_start_stop_times"]};                    // print start and stop times of the thread
-const bool print_new_buffer_started{
-    loaded_json["debugging_settings"]["ProcessorThread"]["print_new_buffer_started"]};                    // print the new buffer started
-const bool print_generation_policy_reception{
-    loaded_json["debugging_settings"]["ProcessorThread"]["print_generation_policy_reception"]};            // print generation policy received from DPL
-const bool print_generation_stream_reception{
-    loaded_json["debugging_settings"]["ProcessorThread"]["print_generation_stream_reception"]};            // print generation stream received from DPL
-const bool disableAllPrints{
-    loaded_json["debugging_settings"]["ProcessorThread"]["disableAllPrints"]};                            // disable all prints
-};
+// debugging_settings::DeploymentThread, ::APVTSMediatorThread and ::ProcessorThread flags are constexpr, generated
+// from the "debugging_settings" section of settings.json into GeneratedSettings.h
 
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "shared_plugin_helpers/shared_plugin_helpers.h"
+#include <array>
 
 using namespace juce;
 
@@ -32,6 +33,8 @@ using namespace juce;
    Additional Policies:
    1. Clear generations after pause/stop
    2. Repeat N times Assuming Generations are T Time Units Long
+   3. Retention (bounds the accumulated stream when previous events are kept):
+        keep the events of the last N beats behind the playhead, and/or the last N events
 */
 
 
@@ -99,6 +102,29 @@ struct PlaybackPolicies {
         return LoopDuration;
     }
 
+    // Retention of previously received events (i.e. with KeepAllPreviousEvents or repeated RelativeToNow streams)
+    // Applied whenever a new stream is merged into the playback sequence:
+    //   KeepLastNBeats  : events older than N beats (quarter notes) behind the playhead are evicted
+    //                     (ignored while looping, since the events behind the playhead are played again)
+    //   KeepLastNEvents : only the N latest events are kept
+    // Both can be active at the same time. Pass a non-positive value to disable.
+    [[maybe_unused]] void SetRetentionPolicy_KeepLastNBeats(double NumBeats) {
+        RetentionBeats = NumBeats;
+    }
+
+    [[maybe_unused]] void SetRetentionPolicy_KeepLastNEvents(int NumEvents) {
+        RetentionEvents = NumEvents;
+    }
+
+    [[maybe_unused]] void DisableRetentionPolicy() {
+        RetentionBeats = -1;
+        RetentionEvents = -1;
+    }
+
+    [[nodiscard]] double getRetentionBeats() const { return RetentionBeats; }
+    [[nodiscard]] int getRetentionEvents() const { return RetentionEvents; }
+    [[nodiscard]] bool IsRetentionPolicyActive() const { return RetentionBeats > 0 || RetentionEvents > 0; }
+
     // Checks if data is ready for transmission
     [[nodiscard]] bool IsReadyForTransmission() const {
         assert (PlaybackPolicy != -1 && "PlaybackPolicy Not Set");
@@ -137,6 +163,8 @@ private:
     bool ClearGenerationsAfterPauseStop{false};
     double LoopDuration{-1};
     bool ForceSendNoteOffsFirst{false};
+    double RetentionBeats{-1};
+    int RetentionEvents{-1};
 };
 
 struct noteOn_ge {
@@ -235,6 +263,31 @@ struct PlaybackSequence {
         messageSequence.updateMatchedPairs();
     }
 
+    // same as calling addNoteWithDuration() for each note, but the events are sorted once and
+    // note on/offs are matched only once at the end (use this when adding many notes at once)
+    [[maybe_unused]] void addNotesWithDuration(const std::vector<paired_note> &notes) {
+        std::vector<MidiMessage> messages;
+        messages.reserve(notes.size() * 2);
+        for (const auto &note : notes) {
+            auto channel = note.noteOn.channel % 16 + 1; // make sure channel is between 1 and 16
+            auto velocity = std::clamp(note.noteOn.velocity, 0.0f, 1.0f); // make sure velocity is between 0 and 1
+            messages.push_back(MidiMessage::noteOn(channel, note.noteOn.noteNumber, velocity)
+                                   .withTimeStamp(note.noteOn.time));
+            messages.push_back(MidiMessage::noteOff(channel, note.noteOn.noteNumber, velocity)
+                                   .withTimeStamp(note.noteOn.time + note.duration));
+        }
+
+        // once sorted, each addEvent() appends to the end of the sequence instead of searching for its slot
+        std::stable_sort(messages.begin(), messages.end(), [](const MidiMessage &a, const MidiMessage &b) {
+            return a.getTimeStamp() < b.getTimeStamp();
+        });
+
+        for (const auto &message : messages) {
+            messageSequence.addEvent(message);
+        }
+        messageSequence.updateMatchedPairs();
+    }
+
     // get NoteOn Info
     [[maybe_unused]] std::vector<noteOn_ge> getNoteOnEvents()  {
         messageSequence.updateMatchedPairs();
@@ -310,15 +363,180 @@ struct PlaybackSequence {
         return messageSequence;
     }
 
+    // direct access to the underlying sequence (i.e. to swap it into another sequence without copying)
+    [[nodiscard]] juce::MidiMessageSequence& getJuceMidiMessageSequence() {
+        return messageSequence;
+    }
+
 private:
     juce::MidiMessageSequence messageSequence{};
 
 };
 
+/*
+ * Note number lookup applied by the playback thread to the notes of the current stream when they are played.
+ * Allows remapping voices (i.e. kick --> another midi note) without resending/replacing the whole stream.
+ * The table is reset to identity whenever a new PlaybackSequence is received.
+ */
+struct NoteRemapTable {
+    NoteRemapTable() {
+        for (int i = 0; i < 128; i++) { notes[i] = i; }
+    }
+
+    void set(int from, int to) {
+        notes[from & 127] = to & 127;
+    }
+
+    [[nodiscard]] int get(int noteNumber) const {
+        return notes[noteNumber & 127];
+    }
+
+    [[nodiscard]] bool isIdentity() const {
+        for (int i = 0; i < 128; i++) {
+            if (notes[i] != i) { return false; }
+        }
+        return true;
+    }
+
+private:
+    std::array<int, 128> notes{};
+};
+
+/*
+ * Incremental changes to the stream currently played by the plugin (instead of resending the whole stream).
+ *
+ * Operations are applied in the order they were added:
+ *      insert       : adds the events of a sequence to the stream
+ *      removeRange  : removes all events in [start, end)
+ *      replaceRange : removeRange(start, end) followed by insert(events)
+ *
+ * Times use the same unit/anchor as the PlaybackSequences (see PlaybackPolicies).
+ * Removing a range only visits the events inside it (the stream is edited in place, not rebuilt).
+ * The number of operations and events per edit is bounded (max_ops/max_events), so that applying an edit
+ * on the playback thread takes bounded time. Adding an operation that exceeds the bounds fails (returns false),
+ * in which case either send the edit so far and start a new one, or resend the whole stream.
+ */
+struct PlaybackSequenceEdit {
+    static constexpr int max_ops = 16;
+    static constexpr int max_events = 256;
+
+    enum class OpType { Insert, RemoveRange, ReplaceRange };
+
+    struct Op {
+        OpType type{OpType::Insert};
+        double start{0};
+        double end{0};
+        juce::MidiMessageSequence events{};
+    };
+
+    PlaybackSequenceEdit() = default;
+
+    [[maybe_unused]] bool insert(PlaybackSequence sequence) {
+        return addOp(OpType::Insert, 0, 0, std::move(sequence));
+    }
+
+    [[maybe_unused]] bool removeRange(double start, double end) {
+        return addOp(OpType::RemoveRange, start, end, PlaybackSequence());
+    }
+
+    [[maybe_unused]] bool replaceRange(double start, double end, PlaybackSequence sequence) {
+        return addOp(OpType::ReplaceRange, start, end, std::move(sequence));
+    }
+
+    [[nodiscard]] bool isEmpty() const { return ops.empty(); }
+    [[nodiscard]] int getNumOps() const { return (int) ops.size(); }
+    [[nodiscard]] int getNumEvents() const { return num_events; }
+
+    void clear() {
+        ops.clear();
+        num_events = 0;
+    }
+
+    // applies the operations to the stream (call updateMatchedPairs() on target afterwards)
+    // time_adjustment is the same offset used when merging a full PlaybackSequence, now is the playhead position
+    // (notes sounding at now whose note off is removed get a note off at now, so they don't hang)
+    void applyTo(juce::MidiMessageSequence &target, double time_adjustment, double now) const {
+        for (const auto &op : ops) {
+            if (op.type != OpType::Insert) {
+                removeEvents(target, op.start + time_adjustment, op.end + time_adjustment, now);
+            }
+            if (op.type != OpType::RemoveRange) {
+                target.addSequence(op.events, time_adjustment);
+            }
+        }
+    }
+
+private:
+    std::vector<Op> ops;
+    int num_events{0};
+
+    bool addOp(OpType type, double start, double end, PlaybackSequence sequence) {
+        auto &events = sequence.getJuceMidiMessageSequence();
+        if ((int) ops.size() >= max_ops || num_events + events.getNumEvents() > max_events || end < start) {
+            return false;
+        }
+        num_events += events.getNumEvents();
+        ops.push_back(Op{type, start, end, std::move(events)});
+        return true;
+    }
+
+    // deletes the events in [start, end) in place: the range is located with getNextIndexAtTime, only the events
+    // inside it are inspected and nothing is reallocated
+    static void removeEvents(juce::MidiMessageSequence &target, double start, double end, double now) {
+        auto first = target.getNextIndexAtTime(start);
+        auto last = target.getNextIndexAtTime(end);
+        if (first >= last) {
+            return;
+        }
+
+        // note offs in the range that don't follow a note on of the range release notes started before it
+        std::array<uint8_t, 16 * 128> open{};          // note ons of the range not released yet
+        std::array<bool, 16 * 128> releases_earlier{};
+        for (int i = first; i < last; i++) {
+            const auto &msg = target.getEventPointer(i)->message;
+            if (!msg.isNoteOnOrOff()) {
+                continue;
+            }
+            auto key = (size_t) ((msg.getChannel() - 1) * 128 + msg.getNoteNumber());
+            if (msg.isNoteOn()) {
+                if (open[key] < 255) { open[key]++; }
+            } else if (open[key] > 0) {
+                open[key]--;
+            } else {
+                releases_earlier[key] = true;
+            }
+        }
+
+        // one such note off per note is kept (moved to the start of the range, or now if later), so notes
+        // sounding when the range starts don't hang
+        auto release_time = std::max(start, now);
+        for (int i = last - 1; i >= first; i--) {
+            auto &msg = target.getEventPointer(i)->message;
+            if (msg.isNoteOff()) {
+                auto key = (size_t) ((msg.getChannel() - 1) * 128 + msg.getNoteNumber());
+                if (releases_earlier[key]) {
+                    releases_earlier[key] = false;
+                    // note offs already behind the playhead keep their time (keeps the sequence sorted)
+                    if (msg.getTimeStamp() >= now) {
+                        msg.setTimeStamp(release_time);
+                    }
+                    continue;
+                }
+            }
+            target.deleteEvent(i, false);
+        }
+    }
+};
+
 /*
   Type:
    1. PlaybackPolicies --> notifies the plugin how to deal with the new stream of generations coming in next
    2. PlaybackSequence --> contains the new stream of generations to be played
+   3. NoteRemapTable   --> remaps the note numbers of the current stream (the stream itself is kept)
+   4. PlaybackSequenceEdit --> inserts/removes/replaces events of the current stream (the rest is kept)
+
+  GenerationEvents are move-only. The PlaybackSequence is allocated once (on the DPL thread) and its ownership
+  is transferred through the queue, so the playback thread can take it over without any copies.
 */
 struct GenerationEvent {
 
@@ -327,33 +545,75 @@ struct GenerationEvent {
 
     GenerationEvent() = default;
 
+    GenerationEvent(GenerationEvent&&) noexcept = default;
+    GenerationEvent& operator=(GenerationEvent&&) noexcept = default;
+    GenerationEvent(const GenerationEvent&) = delete;
+    GenerationEvent& operator=(const GenerationEvent&) = delete;
+
     explicit GenerationEvent(PlaybackPolicies nse) {
         timer.registerStartTime();
         type = 1;
         playbackPolicies = nse;
     }
 
+    // takes over the content of the sequence (pass with std::move to avoid a copy)
     explicit GenerationEvent(PlaybackSequence ps) {
         timer.registerStartTime();
         type = 2;
-        playbackSequence = ps;
+        playbackSequence = std::make_unique<PlaybackSequence>(std::move(ps));
+    }
+
+    explicit GenerationEvent(NoteRemapTable table) {
+        timer.registerStartTime();
+        type = 3;
+        noteRemapTable = table;
+    }
+
+    explicit GenerationEvent(PlaybackSequenceEdit edit) {
+        timer.registerStartTime();
+        type = 4;
+        sequenceEdit = std::make_unique<PlaybackSequenceEdit>(std::move(edit));
     }
 
     [[nodiscard]] bool IsNewPlaybackPolicyEvent() const { return type == 1; }
     [[nodiscard]] PlaybackPolicies getNewPlaybackPolicyEvent () const { return playbackPolicies; }
 
     [[nodiscard]] bool IsNewPlaybackSequence() const { return type == 2; }
-    [[nodiscard]] PlaybackSequence getNewPlaybackSequence() const { return playbackSequence; }
+    [[nodiscard]] const PlaybackSequence& getNewPlaybackSequence() const {
+        return playbackSequence ? *playbackSequence : emptySequence();
+    }
+    // mutable access, i.e. to swap the content into the playback sequence (only valid if IsNewPlaybackSequence())
+    [[nodiscard]] PlaybackSequence& getNewPlaybackSequence() {
+        jassert (playbackSequence != nullptr);
+        return *playbackSequence;
+    }
+
+    [[nodiscard]] bool IsNoteRemap() const { return type == 3; }
+    [[nodiscard]] const NoteRemapTable& getNoteRemapTable() const { return noteRemapTable; }
+
+    [[nodiscard]] bool IsPlaybackSequenceEdit() const { return type == 4; }
+    // only valid if IsPlaybackSequenceEdit()
+    [[nodiscard]] const PlaybackSequenceEdit& getPlaybackSequenceEdit() const {
+        jassert (sequenceEdit != nullptr);
+        return *sequenceEdit;
+    }
 
     [[maybe_unused]] [[nodiscard]] juce::MidiMessageSequence getAsJuceMidMessageSequence() const {
-        return playbackSequence.getAsJuceMidMessageSequence();
+        return getNewPlaybackSequence().getAsJuceMidMessageSequence();
     }
 private:
     PlaybackPolicies playbackPolicies {};
-    PlaybackSequence playbackSequence {};
+    std::unique_ptr<PlaybackSequence> playbackSequence {};
+    NoteRemapTable noteRemapTable {};
+    std::unique_ptr<PlaybackSequenceEdit> sequenceEdit {};
 
     // uses chrono::system_clock to time events (for debugging only)
     // don't use this for anything else than debugging.
     // used to keep track of when the object was created and when it was accessed
     chrono_timer timer;
+
+    static const PlaybackSequence& emptySequence() {
+        static const PlaybackSequence empty{};
+        return empty;
+    }
 };
\ No newline at end of file
@@ -42,13 +42,14 @@ struct param {
 
     param() = default;
 
-    void InitializeSlider(json slider_or_rotary_json, bool isSlider_) {
-        label = slider_or_rotary_json["label"].get<std::string>();
-        value = slider_or_rotary_json["default"].get<double>();
+    // the widgets are described by generated_settings::parameters (compiled in from settings.json)
+    void InitializeSlider(const generated_settings::ParamDescriptor& descriptor, bool isSlider_) {
+        label = descriptor.label;
+        value = descriptor.default_value;
         paramID = label2ParamID(label);
-        min = slider_or_rotary_json["min"].get<double>();
-        max = slider_or_rotary_json["max"].get<double>();
-        defaultVal = slider_or_rotary_json["default"].get<double>();
+        min = descriptor.min;
+        max = descriptor.max;
+        defaultVal = descriptor.default_value;
         isSlider = isSlider_;
         isRotary = !isSlider_;
         isButton = false;
@@ -70,8 +71,8 @@ struct param {
         isChanged = true; // first time update is always true
     }
 
-    void InitializeButton(json button_json) {
-        label = button_json["label"].get<std::string>();
+    void InitializeButton(const generated_settings::ParamDescriptor& descriptor) {
+        label = descriptor.label;
         value = 0;
         paramID = label2ParamID(label);
         min = std::nullopt;
@@ -80,17 +81,17 @@ struct param {
         isSlider = false;
         isRotary = false;
         isButton = true;
-        isToggle = button_json["isToggle"].get<bool>();
+        isToggle = descriptor.is_toggle;
         isChanged = isToggle; // only true if isToggle.
         // We don't want to trigger the button if it's not a toggle
     }
 
-    void InitializeCombobox(json comboBox_json) {
-        label = comboBox_json["label"].get<std::string>();
+    void InitializeCombobox(const generated_settings::ParamDescriptor& descriptor) {
+        label = descriptor.label;
         value = 1;
         paramID = label2ParamID(label);
         min = 1;
-        comboBoxOptions = comboBox_json["items"].get<std::vector<std::string>>();
+        comboBoxOptions.assign(descriptor.items, descriptor.items + descriptor.num_items);
         max = comboBoxOptions.size();
         defaultVal = 1;
         isSlider = false;
@@ -198,6 +199,15 @@ struct GuiParams {
         isChanged = isChanged_;
     }
 
+    // true if the changes come from a preset that was just applied (the preset data changed along with them)
+    [[nodiscard]] bool wasPresetApplied() const {
+        return presetApplied;
+    }
+
+    void setPresetApplied(bool presetApplied_) {
+        presetApplied = presetApplied_;
+    }
+
     [[maybe_unused]] bool wasParamUpdated(const string &label) {
         for (auto &parameter: Parameters) {
             if (parameter.paramID == label2ParamID(label)) {
@@ -306,6 +316,7 @@ struct GuiParams {
 private:
     vector<param> Parameters;
     bool isChanged = true;
+    bool presetApplied = false;
     juce::AudioProcessorValueTreeState *apvtsPntr{};
 
     // uses chrono::system_clock to time parameter arrival to consumption (for debugging only)
@@ -336,79 +347,38 @@ private:
     void construct() {
         chrono_timed.registerStartTime();
 
-        auto tabList = UIObjects::Tabs::tabList;
-
-        for (auto tab_list: tabList) {
-
-            auto slidersList = std::get<1>(tab_list);
-            auto rotariesList = std::get<2>(tab_list);
-            auto buttonsList = std::get<3>(tab_list);
-            auto vslidersList = std::get<4>(tab_list);
-            auto comboBoxesList = std::get<5>(tab_list);
-            auto triangleSlidersList = std::get<10>(tab_list);
-
-            for (const auto &slider_json: slidersList) {
-                auto label = slider_json["label"].get<std::string>();
-                if (assertLabelIsUnique(label)) {
-                    auto param_ = param();
-                    param_.InitializeSlider(slider_json, true);
-                    Parameters.emplace_back(param_);
-                }
-            }
-
-            for (const auto &vslider_json: vslidersList) {
-                auto label = vslider_json["label"].get<std::string>();
-                if (assertLabelIsUnique(label)) {
-                    auto param_ = param();
-                    param_.InitializeSlider(vslider_json, true);
-                    Parameters.emplace_back(param_);
-                }
+        // compiled in from settings.json, so constructing the params never parses the json
+        using generated_settings::ParamKind;
+        for (const auto &descriptor: generated_settings::parameters) {
+            if (descriptor.kind == ParamKind::MidiDisplay || descriptor.kind == ParamKind::AudioDisplay ||
+                descriptor.kind == ParamKind::None) {
+                continue;
             }
 
-            for (const auto &rotary_json: rotariesList) {
-                auto label = rotary_json["label"].get<std::string>();
-                if (assertLabelIsUnique(label)) {
-                    auto param_ = param();
-                    param_.InitializeSlider(rotary_json, false);
-                    Parameters.emplace_back(param_);
-                }
+            if (!assertLabelIsUnique(descriptor.label)) {
+                continue;
             }
 
-            for (const auto &button_json: buttonsList) {
-                std::string label = button_json["label"].get<std::string>();
-                if (assertLabelIsUnique(label)) {
-                    auto param_ = param();
-                    param_.InitializeButton(button_json);
-                    Parameters.emplace_back(param_);
-                }
-            }
-
-            for (const auto &comboBox_json: comboBoxesList) {
-                std::string label = comboBox_json["label"].get<std::string>();
-                if (assertLabelIsUnique(label)) {
-                    auto param_ = param();
-                    param_.InitializeCombobox(comboBox_json);
-                    Parameters.emplace_back(param_);
-                }
-            }
-
-            for (const auto &triangleSlider_json: triangleSlidersList) {
-                std::string DistanceFromBottomLeftCornerSlider = triangleSlider_json["DistanceFromBottomLeftCornerSlider"].get<std::string>();
-                std::string HeightSlider = triangleSlider_json["HeightSlider"].get<std::string>();
-
-                if (assertLabelIsUnique(DistanceFromBottomLeftCornerSlider)) {
-                    auto param_ = param();
-                    param_.initializeTriangleSlider(DistanceFromBottomLeftCornerSlider, 0.0f, 0.0f, 1.0f);
-                    Parameters.emplace_back(param_);
-                }
-
-                if (assertLabelIsUnique(HeightSlider)) {
-                    auto param_ = param();
-                    param_.initializeTriangleSlider(HeightSlider, 0.5, 0, 1);
-                    Parameters.emplace_back(param_);
-                }
-
+            auto param_ = param();
+            switch (descriptor.kind) {
+                case ParamKind::Slider:
+                    param_.InitializeSlider(descriptor, true);
+                    break;
+                case ParamKind::Rotary:
+                    param_.InitializeSlider(descriptor, false);
+                    break;
+                case ParamKind::Button:
+                    param_.InitializeButton(descriptor);
+                    break;
+                case ParamKind::ComboBox:
+                    param_.InitializeCombobox(descriptor);
+                    break;
+                default:        // triangle slider axes
+                    param_.initializeTriangleSlider(
+                        descriptor.label, descriptor.default_value, descriptor.min, descriptor.max);
+                    break;
             }
+            Parameters.emplace_back(param_);
         }
     }
 
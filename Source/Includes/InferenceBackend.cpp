@@ -0,0 +1,227 @@
+#include "InferenceBackend.h"
+#include "shared_plugin_helpers/shared_plugin_helpers.h"
+
+#include <fstream>
+#include <map>
+
+#if defined(_WIN32) || defined(_WIN64)
+#   define WIN32_LEAN_AND_MEAN
+#   define NOMINMAX
+#   include <Windows.h>
+#   include <psapi.h>
+#elif defined(__APPLE__)
+#   include <mach/mach.h>
+#else
+#   include <unistd.h>
+#endif
+
+#if NMFX_WITH_ONNXRUNTIME
+#   include <onnxruntime_cxx_api.h>
+#endif
+
+// ============================================================================================================
+// ==========          Resident Memory                                =========================================
+// ============================================================================================================
+size_t getResidentMemoryKB() {
+#if defined(_WIN32) || defined(_WIN64)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.WorkingSetSize / 1024;
+    }
+    return 0;
+#elif defined(__APPLE__)
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t) &info, &count) == KERN_SUCCESS) {
+        return info.resident_size / 1024;
+    }
+    return 0;
+#else
+    // second field of statm is the number of resident pages
+    std::ifstream statm("/proc/self/statm");
+    size_t total_pages = 0;
+    size_t resident_pages = 0;
+    if (statm >> total_pages >> resident_pages) {
+        return resident_pages * (size_t) sysconf(_SC_PAGESIZE) / 1024;
+    }
+    return 0;
+#endif
+}
+
+// ============================================================================================================
+// ==========          OnnxRuntimeBackend                             =========================================
+// ============================================================================================================
+#if NMFX_WITH_ONNXRUNTIME
+
+class OnnxRuntimeBackend : public InferenceBackend {
+public:
+    OnnxRuntimeBackend() : env(ORT_LOGGING_LEVEL_WARNING, "NeuralMidiFX") {
+        options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+        options.SetIntraOpNumThreads(1);
+    }
+
+    bool load(const std::string& path) override {
+        sessions.clear();
+
+        auto stem = path.substr(0, path.size() - std::string(".onnx").size());
+        auto directory = stem.substr(0, stem.find_last_of("/\\") + 1);
+        auto prefix = stem.substr(directory.size()) + "_";
+
+        // <stem>.onnx --> forward
+        if (std::ifstream(path).good()) {
+            addSession("forward", path);
+        }
+
+        // <stem>_<method>.onnx --> <method>
+        auto files = juce::File(directory).findChildFiles(juce::File::findFiles, false, prefix + "*.onnx");
+        for (const auto& file : files) {
+            auto method = file.getFileNameWithoutExtension().substring((int) prefix.size()).toStdString();
+            addSession(method, file.getFullPathName().toStdString());
+        }
+
+        if (sessions.empty()) {
+            std::cout << "No onnx model found for: " << path << std::endl;
+        }
+        return isLoaded();
+    }
+
+    [[nodiscard]] bool isLoaded() const override { return !sessions.empty(); }
+
+    [[nodiscard]] bool hasMethod(const std::string& method) const override {
+        return sessions.find(method) != sessions.end();
+    }
+
+    std::vector<torch::Tensor> run(const std::string& method, const std::vector<torch::Tensor>& inputs) override {
+        auto& entry = sessions.at(method);
+
+        // inputs are wrapped without copying (the contiguous tensors are kept alive until the end of the call)
+        std::vector<torch::Tensor> contiguous_inputs;
+        std::vector<Ort::Value> ort_inputs;
+        for (const auto& input : inputs) {
+            auto tensor = input.dim() == 0 ? input.reshape({1}).contiguous() : input.contiguous();
+            contiguous_inputs.push_back(tensor);
+            ort_inputs.push_back(toOrtValue(contiguous_inputs.back()));
+        }
+
+        auto ort_outputs = entry.session->Run(
+            Ort::RunOptions{nullptr},
+            entry.input_names_ptrs.data(), ort_inputs.data(), ort_inputs.size(),
+            entry.output_names_ptrs.data(), entry.output_names_ptrs.size());
+
+        std::vector<torch::Tensor> outputs;
+        for (auto& value : ort_outputs) {
+            outputs.push_back(toTorchTensor(value));
+        }
+        return outputs;
+    }
+
+    // takes effect on the sessions created after this call, so the sessions are recreated
+    void setNumThreads(int num_threads) override {
+        options.SetIntraOpNumThreads(num_threads);
+        for (auto& [method, entry] : sessions) {
+            try {
+                entry.session = std::make_unique<Ort::Session>(env, toOrtPath(entry.path).c_str(), options);
+            } catch (const Ort::Exception& e) {   // the previous session is kept
+                std::cout << "Failed to recreate onnx session " << entry.path << ": " << e.what() << std::endl;
+            }
+        }
+    }
+
+    [[nodiscard]] std::string getName() const override { return "ONNX Runtime"; }
+
+private:
+    struct SessionEntry {
+        std::string path;
+        std::unique_ptr<Ort::Session> session;
+        std::vector<std::string> input_names;
+        std::vector<std::string> output_names;
+        std::vector<const char*> input_names_ptrs;
+        std::vector<const char*> output_names_ptrs;
+    };
+
+    Ort::Env env;
+    Ort::SessionOptions options;
+    Ort::MemoryInfo memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+    std::map<std::string, SessionEntry> sessions;
+
+#if defined(_WIN32) || defined(_WIN64)
+    static std::wstring toOrtPath(const std::string& path) { return juce::String(path).toWideCharPointer(); }
+#else
+    static std::string toOrtPath(const std::string& path) { return path; }
+#endif
+
+    // a model that fails to load (corrupted file, unsupported opset, ...) is skipped
+    void addSession(const std::string& method, const std::string& path) {
+        SessionEntry entry;
+        entry.path = path;
+        try {
+            entry.session = std::make_unique<Ort::Session>(env, toOrtPath(path).c_str(), options);
+
+            Ort::AllocatorWithDefaultOptions allocator;
+            for (size_t i = 0; i < entry.session->GetInputCount(); i++) {
+                entry.input_names.emplace_back(entry.session->GetInputNameAllocated(i, allocator).get());
+            }
+            for (size_t i = 0; i < entry.session->GetOutputCount(); i++) {
+                entry.output_names.emplace_back(entry.session->GetOutputNameAllocated(i, allocator).get());
+            }
+        } catch (const Ort::Exception& e) {
+            std::cout << "Failed to load onnx model " << path << ": " << e.what() << std::endl;
+            return;
+        }
+
+        // pointers are taken once the entry is in place (moving short strings invalidates their c_str())
+        auto& stored = sessions[method];
+        stored = std::move(entry);
+        for (const auto& n : stored.input_names) { stored.input_names_ptrs.push_back(n.c_str()); }
+        for (const auto& n : stored.output_names) { stored.output_names_ptrs.push_back(n.c_str()); }
+    }
+
+    Ort::Value toOrtValue(const torch::Tensor& tensor) const {
+        auto shape = tensor.sizes().vec();
+        switch (tensor.scalar_type()) {
+            case torch::kFloat32:
+                return Ort::Value::CreateTensor<float>(memory_info, tensor.data_ptr<float>(), (size_t) tensor.numel(),
+                                                       shape.data(), shape.size());
+            case torch::kInt64:
+                return Ort::Value::CreateTensor<int64_t>(memory_info, tensor.data_ptr<int64_t>(),
+                                                         (size_t) tensor.numel(), shape.data(), shape.size());
+            case torch::kInt32:
+                return Ort::Value::CreateTensor<int32_t>(memory_info, tensor.data_ptr<int32_t>(),
+                                                         (size_t) tensor.numel(), shape.data(), shape.size());
+            case torch::kBool:
+                return Ort::Value::CreateTensor<bool>(memory_info, tensor.data_ptr<bool>(), (size_t) tensor.numel(),
+                                                      shape.data(), shape.size());
+            default:
+                throw std::runtime_error("OnnxRuntimeBackend: unsupported input dtype");
+        }
+    }
+
+    static torch::Tensor toTorchTensor(Ort::Value& value) {
+        auto info = value.GetTensorTypeAndShapeInfo();
+        auto shape = info.GetShape();
+        switch (info.GetElementType()) {
+            case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT:
+                return torch::from_blob(value.GetTensorMutableData<float>(), shape, torch::kFloat32).clone();
+            case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64:
+                return torch::from_blob(value.GetTensorMutableData<int64_t>(), shape, torch::kInt64).clone();
+            case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT32:
+                return torch::from_blob(value.GetTensorMutableData<int32_t>(), shape, torch::kInt32).clone();
+            case ONNX_TENSOR_ELEMENT_DATA_TYPE_BOOL:
+                return torch::from_blob(value.GetTensorMutableData<bool>(), shape, torch::kBool).clone();
+            default:
+                throw std::runtime_error("OnnxRuntimeBackend: unsupported output dtype");
+        }
+    }
+};
+
+std::shared_ptr<InferenceBackend> createOnnxRuntimeBackend() {
+    return std::make_shared<OnnxRuntimeBackend>();
+}
+
+#else
+
+std::shared_ptr<InferenceBackend> createOnnxRuntimeBackend() {
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <torch/script.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+// ============================================================================================================
+// ==========          InferenceBackend                               =========================================
+// ============================================================================================================
+/*
+ * Runtime agnostic access to a model exposing named methods (i.e. "encode", "sample").
+ *
+ * Inputs and outputs are always lists of tensors. Scalars are passed as 0-dim tensors, the backend converts
+ * them to whatever its runtime expects. Tuple outputs are flattened in order.
+ *
+ * Implementations:
+ *      TorchScriptBackend     : torch::jit::script::Module (always available)
+ *      OnnxRuntimeBackend     : ONNX Runtime CPU session(s), only if built with NMFX_WITH_ONNXRUNTIME
+ *                               (see createOnnxRuntimeBackend())
+ *      OutOfProcessBackend    : TorchScript model hosted by a helper process (see createOutOfProcessBackend())
+ *
+ * A backend instance is not meant to be used from several threads at the same time, except for run() which
+ * only reads the model (same as torch::jit::script::Module).
+ */
+class InferenceBackend {
+public:
+    virtual ~InferenceBackend() = default;
+
+    // loads the model at the given path, returns false if not possible
+    virtual bool load(const std::string& path) = 0;
+
+    [[nodiscard]] virtual bool isLoaded() const = 0;
+
+    [[nodiscard]] virtual bool hasMethod(const std::string& method) const = 0;
+
+    // runs a named method of the model
+    // an empty list means the call failed (already logged, i.e. OutOfProcessBackend when the host can't run it)
+    virtual std::vector<torch::Tensor> run(const std::string& method, const std::vector<torch::Tensor>& inputs) = 0;
+
+    // runs the method a few times so that allocations/lazy initializations don't hit the first real call
+    virtual void warmUp(const std::string& method, const std::vector<torch::Tensor>& inputs, int num_runs = 3) {
+        for (int i = 0; i < num_runs; i++) {
+            run(method, inputs);
+        }
+    }
+
+    // number of intra-op threads used by the runtime
+    virtual void setNumThreads(int num_threads) = 0;
+
+    [[nodiscard]] virtual std::string getName() const = 0;
+};
+
+
+// ============================================================================================================
+// ==========          TorchScriptBackend                             =========================================
+// ============================================================================================================
+class TorchScriptBackend : public InferenceBackend {
+public:
+    TorchScriptBackend() = default;
+
+    // wraps an already loaded module (modules are shared handles, no copy of the weights is made)
+    explicit TorchScriptBackend(torch::jit::script::Module module_, std::string name_ = "TorchScript") :
+        module(std::move(module_)), name(std::move(name_)), loaded(true) {}
+
+    bool load(const std::string& path) override {
+        try {
+            module = torch::jit::load(path);
+            loaded = true;
+        } catch (const c10::Error& e) {
+            std::cout << "Failed to load TorchScript model: " << path << std::endl;
+            loaded = false;
+        }
+        return loaded;
+    }
+
+    [[nodiscard]] bool isLoaded() const override { return loaded; }
+
+    [[nodiscard]] bool hasMethod(const std::string& method) const override {
+        return loaded && module.find_method(method).has_value();
+    }
+
+    std::vector<torch::Tensor> run(const std::string& method, const std::vector<torch::Tensor>& inputs) override {
+        auto scripted_method = module.get_method(method);
+
+        // 0-dim tensors are converted to the scalar types in the signature of the method (skipping self)
+        const auto& arguments = scripted_method.function().getSchema().arguments();
+        size_t first_arg = (!arguments.empty() && arguments[0].name() == "self") ? 1 : 0;
+
+        std::vector<torch::jit::IValue> ivalues;
+        ivalues.reserve(inputs.size());
+        for (size_t i = 0; i < inputs.size(); i++) {
+            const auto& input = inputs[i];
+            if (input.dim() == 0 && first_arg + i < arguments.size()) {
+                auto kind = arguments[first_arg + i].type()->kind();
+                if (kind == c10::TypeKind::IntType) { ivalues.emplace_back(input.item<int64_t>()); continue; }
+                if (kind == c10::TypeKind::FloatType) { ivalues.emplace_back(input.item<double>()); continue; }
+                if (kind == c10::TypeKind::BoolType) { ivalues.emplace_back(input.item<bool>()); continue; }
+            }
+            ivalues.emplace_back(input);
+        }
+
+        auto output = scripted_method(ivalues);
+
+        std::vector<torch::Tensor> outputs;
+        if (output.isTuple()) {
+            for (const auto& element : output.toTuple()->elements()) {
+                outputs.push_back(element.toTensor());
+            }
+        } else if (output.isTensorList()) {
+            for (const auto& tensor : output.toTensorVector()) {
+                outputs.push_back(tensor);
+            }
+        } else {
+            outputs.push_back(output.toTensor());
+        }
+        return outputs;
+    }
+
+    [[nodiscard]] std::vector<std::string> getMethodNames() const {
+        std::vector<std::string> names;
+        if (loaded) {
+            for (const auto& method : module.get_methods()) { names.push_back(method.name()); }
+        }
+        return names;
+    }
+
+    // NOTE: libtorch's thread pool is process wide, so this affects all TorchScript backends
+    void setNumThreads(int num_threads) override {
+        torch::set_num_threads(num_threads);
+    }
+
+    [[nodiscard]] std::string getName() const override { return name; }
+
+private:
+    torch::jit::script::Module module;
+    std::string name{"TorchScript"};
+    bool loaded{false};
+};
+
+
+// ============================================================================================================
+// ==========          Other Backends / Helpers  (implemented in InferenceBackend.cpp)       ==================
+// ============================================================================================================
+
+// ONNX Runtime (CPU) backend
+// load(path) expects the exported model (i.e. drumLoopVAE.onnx). Since an onnx graph has a single entry point,
+// each method is exported to its own file next to it: <stem>_<method>.onnx (i.e. drumLoopVAE_encode.onnx).
+// <stem>.onnx itself is available as the "forward" method.
+// returns nullptr if the plugin was built without NMFX_WITH_ONNXRUNTIME
+std::shared_ptr<InferenceBackend> createOnnxRuntimeBackend();
+
+// TorchScript model hosted by the inference host process (Source/InferenceHost), so that a crash in the model
+// doesn't take down the host application. The host is launched by load(path) and relaunched if it crashes or
+// hangs. Requests/responses go through lock-free shared memory rings (see InferenceHostProtocol.h)
+std::shared_ptr<InferenceBackend> createOutOfProcessBackend(const std::string& host_path);
+
+// location of the inference host executable installed by the build, empty if it wasn't built
+std::string getDefaultInferenceHostPath();
+
+// current resident memory of the process in KB (0 if not available on the platform)
+size_t getResidentMemoryKB();
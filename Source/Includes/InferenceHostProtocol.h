@@ -0,0 +1,164 @@
+#pragma once
+
+#include "SharedMemoryRing.h"
+#include <torch/script.h>
+#include <string>
+#include <vector>
+
+// ============================================================================================================
+// ==========          Inference Host Protocol                        =========================================
+// ============================================================================================================
+/*
+ * Messages exchanged between the plugin (OutOfProcessBackend) and the inference host process.
+ *
+ * Both processes map the same segment holding two rings:
+ *      requests  : plugin --> host
+ *      responses : host   --> plugin
+ * Each request is answered with a response carrying the same request_id.
+ *
+ * Message layout (native byte order, both processes run on the same machine):
+ *      [uint32 kind][uint32 status][uint64 request_id][int64 int_arg][uint32 text size][text]
+ *      [uint32 num tensors] { [int32 dtype][int32 ndim][int64 sizes...][raw contiguous data] } ...
+ */
+namespace inference_host {
+
+    constexpr uint32_t ring_capacity = 4 * 1024 * 1024;     // per direction
+    constexpr uint32_t segment_magic = 0x4E4D4658;          // "NMFX"
+
+    enum class Kind : uint32_t {
+        Load = 1,           // text: model path              --> text: comma separated list of methods
+        Run = 2,            // text: method, tensors: inputs --> tensors: outputs
+        SetNumThreads = 3,  // int_arg: number of threads
+        Shutdown = 4
+    };
+
+    enum class Status : uint32_t { Ok = 0, Error = 1 };     // on error, text holds the message
+
+    struct SegmentHeader {
+        uint32_t magic{0};
+        uint32_t capacity{0};
+    };
+
+    // offsets of the rings in the segment
+    inline size_t requestRingOffset() { return 64; }
+    inline size_t responseRingOffset() {
+        auto request_ring_size = SharedMemoryRing::bytesRequired(ring_capacity);
+        return requestRingOffset() + ((request_ring_size + 63) & ~(size_t) 63);     // rings are 64 byte aligned
+    }
+    inline size_t segmentSize() { return responseRingOffset() + SharedMemoryRing::bytesRequired(ring_capacity); }
+
+    // messages larger than a ring (size prefix included) can never be sent, they are answered with an error
+    inline bool fitsInRing(size_t message_size) { return message_size + sizeof(uint32_t) <= ring_capacity; }
+    inline std::string messageTooLarge(size_t message_size) {
+        return "Message too large (" + std::to_string(message_size) + " bytes, the rings hold " +
+               std::to_string(ring_capacity) + ")";
+    }
+
+    // dtypes that can be sent over the rings
+    inline bool isSupportedDtype(int32_t dtype) {
+        switch ((c10::ScalarType) dtype) {
+            case c10::ScalarType::Byte:
+            case c10::ScalarType::Char:
+            case c10::ScalarType::Short:
+            case c10::ScalarType::Int:
+            case c10::ScalarType::Long:
+            case c10::ScalarType::Half:
+            case c10::ScalarType::Float:
+            case c10::ScalarType::Double:
+            case c10::ScalarType::Bool:
+            case c10::ScalarType::BFloat16:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    struct Message {
+        Kind kind{Kind::Run};
+        Status status{Status::Ok};
+        uint64_t request_id{0};
+        int64_t int_arg{0};
+        std::string text;
+        std::vector<torch::Tensor> tensors;
+
+        void serialize(std::vector<uint8_t> &out) const {
+            out.clear();
+            append(out, (uint32_t) kind);
+            append(out, (uint32_t) status);
+            append(out, request_id);
+            append(out, int_arg);
+            append(out, (uint32_t) text.size());
+            out.insert(out.end(), text.begin(), text.end());
+            append(out, (uint32_t) tensors.size());
+            for (const auto &t : tensors) {
+                auto tensor = t.contiguous();
+                append(out, (int32_t) tensor.scalar_type());
+                append(out, (int32_t) tensor.dim());
+                for (auto size : tensor.sizes()) { append(out, (int64_t) size); }
+                auto bytes = reinterpret_cast<const uint8_t *>(tensor.data_ptr());
+                out.insert(out.end(), bytes, bytes + tensor.nbytes());
+            }
+        }
+
+        // returns false if the message is malformed
+        bool deserialize(const std::vector<uint8_t> &in) {
+            size_t pos = 0;
+            uint32_t kind_ = 0, status_ = 0, text_size = 0, num_tensors = 0;
+            if (!read(in, pos, kind_) || !read(in, pos, status_) || !read(in, pos, request_id) ||
+                !read(in, pos, int_arg) || !read(in, pos, text_size) || pos + text_size > in.size()) {
+                return false;
+            }
+            kind = (Kind) kind_;
+            status = (Status) status_;
+            text.assign(reinterpret_cast<const char *>(in.data() + pos), text_size);
+            pos += text_size;
+
+            if (!read(in, pos, num_tensors)) {
+                return false;
+            }
+            tensors.clear();
+            for (uint32_t i = 0; i < num_tensors; i++) {
+                int32_t dtype = 0, ndim = 0;
+                if (!read(in, pos, dtype) || !read(in, pos, ndim) || !isSupportedDtype(dtype) ||
+                    ndim < 0 || ndim > max_ndim) {
+                    return false;
+                }
+                // sizes are checked against the message before allocating anything
+                std::vector<int64_t> sizes((size_t) ndim);
+                size_t num_bytes = c10::elementSize((c10::ScalarType) dtype);
+                for (auto &size : sizes) {
+                    if (!read(in, pos, size) || size < 0) { return false; }
+                    if (size > 0 && num_bytes > (in.size() - pos) / (size_t) size) { return false; }
+                    num_bytes *= (size_t) size;
+                }
+                if (pos + num_bytes > in.size()) {
+                    return false;
+                }
+                auto tensor = torch::empty(sizes, torch::TensorOptions().dtype((c10::ScalarType) dtype));
+                std::memcpy(tensor.data_ptr(), in.data() + pos, tensor.nbytes());
+                pos += tensor.nbytes();
+                tensors.push_back(tensor);
+            }
+            return true;
+        }
+
+    private:
+        static constexpr int32_t max_ndim = 16;
+
+        template <typename T>
+        static void append(std::vector<uint8_t> &out, T value) {
+            auto bytes = reinterpret_cast<const uint8_t *>(&value);
+            out.insert(out.end(), bytes, bytes + sizeof(T));
+        }
+
+        template <typename T>
+        static bool read(const std::vector<uint8_t> &in, size_t &pos, T &value) {
+            if (pos + sizeof(T) > in.size()) {
+                return false;
+            }
+            std::memcpy(&value, in.data() + pos, sizeof(T));
+            pos += sizeof(T);
+            return true;
+        }
+    };
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+// ============================================================================================================
+// ==========          Content Hashing (FNV-1a)                      ==========================================
+// ============================================================================================================
+// hashes raw bytes (i.e. contiguous tensor/array data). Seed with a previous hash to chain several buffers
+inline uint64_t hash_bytes(const void* data, size_t num_bytes, uint64_t seed = 14695981039346656037ULL) {
+    auto bytes = static_cast<const uint8_t*>(data);
+    uint64_t h = seed;
+    for (size_t i = 0; i < num_bytes; i++) {
+        h ^= bytes[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+// mixes a value into an existing hash (boost::hash_combine style)
+inline uint64_t hash_combine(uint64_t seed, uint64_t value) {
+    return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
+// ============================================================================================================
+// ==========          LRUCache (thread-safe, Least Recently Used eviction)          ==========================
+// ============================================================================================================
+/*
+ * Fixed capacity key/value store. Reading or writing an entry marks it as the most recently used one,
+ * when the capacity is exceeded the least recently used entry is evicted.
+ *
+ * All methods lock an internal mutex, so the cache can be shared between the DeploymentThread and
+ * any helper threads. DO NOT use it inside processBlock().
+ */
+template<typename Key, typename Value, typename Hash = std::hash<Key>>
+class LRUCache {
+public:
+    explicit LRUCache(size_t capacity_) : capacity(capacity_) {}
+
+    // returns the value if available (and marks it as most recently used), nullopt otherwise
+    std::optional<Value> get(const Key& key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(key);
+        if (it == index.end()) {
+            num_misses++;
+            return std::nullopt;
+        }
+        entries.splice(entries.begin(), entries, it->second);
+        num_hits++;
+        return it->second->second;
+    }
+
+    // checks availability without updating the usage order or the hit/miss counters
+    [[nodiscard]] bool contains(const Key& key) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return index.find(key) != index.end();
+    }
+
+    void put(const Key& key, Value value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(key);
+        if (it != index.end()) {
+            it->second->second = std::move(value);
+            entries.splice(entries.begin(), entries, it->second);
+            return;
+        }
+
+        entries.emplace_front(key, std::move(value));
+        index[key] = entries.begin();
+
+        // evict least recently used entries
+        while (entries.size() > capacity) {
+            index.erase(entries.back().first);
+            entries.pop_back();
+        }
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.clear();
+        index.clear();
+    }
+
+    [[nodiscard]] size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return entries.size();
+    }
+
+    [[nodiscard]] uint64_t getNumHits() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return num_hits;
+    }
+
+    [[nodiscard]] uint64_t getNumMisses() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return num_misses;
+    }
+
+private:
+    using entry_list = std::list<std::pair<Key, Value>>;
+
+    size_t capacity;
+    entry_list entries;     // front is the most recently used entry
+    std::unordered_map<Key, typename entry_list::iterator, Hash> index;
+    mutable std::mutex mutex;
+
+    uint64_t num_hits{0};
+    uint64_t num_misses{0};
+};
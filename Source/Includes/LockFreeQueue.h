@@ -9,6 +9,7 @@
 
 #include <torch/script.h> // One-stop header.
 
+#include <type_traits>
 #include <utility>
 
 
@@ -46,6 +47,8 @@ public:
         return lockFreeFifo->getNumReady();
     }
 
+    // T can be move-only (i.e. GenerationEvent), in which case the data is moved into the queue
+    // and getLatestDataWithoutMovingFIFOHeads() is not available
     void push(T writeData) {
 
         int start1, start2, blockSize1, blockSize2;
@@ -54,8 +57,10 @@ public:
                 1, start1, blockSize1,
                 start2, blockSize2);
         auto start_data_ptr = data.getRawDataPointer() + start1;
-        *start_data_ptr = make_unique<T>(writeData);
-        latest_written_data = writeData;
+        if constexpr (std::is_copy_assignable_v<T>) {
+            latest_written_data = writeData;
+        }
+        *start_data_ptr = make_unique<T>(std::move(writeData));
         num_writes += 1;
         lockFreeFifo->finishedWrite(1);
 
@@ -91,7 +96,7 @@ public:
 
         if (blockSize2 > 0) {
             auto start_data_ptr = data.getRawDataPointer() + start2;
-            readData = *(*(start_data_ptr+blockSize2-1));
+            readData = std::move(*(*(start_data_ptr+blockSize2-1)));
             lockFreeFifo -> finishedRead(blockSize1+blockSize2);
             num_reads += 1;
             return readData;
@@ -99,7 +104,7 @@ public:
         }
         if (blockSize1 > 0) {
             auto start_data_ptr = data.getRawDataPointer() + start1;
-            readData = *(*(start_data_ptr+blockSize1-1));
+            readData = std::move(*(*(start_data_ptr+blockSize1-1)));
             lockFreeFifo -> finishedRead(blockSize1+blockSize2);
             num_reads += 1;
             return readData;
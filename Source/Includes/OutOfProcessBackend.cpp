@@ -0,0 +1,249 @@
+#include "GeneratedSettings.h"      // generated from settings.json at configure time
+#include "InferenceBackend.h"
+#include "InferenceHostProtocol.h"
+#include "shared_plugin_helpers/shared_plugin_helpers.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+
+#define STRINGIFY(x) #x
+#define TOSTRING(x) STRINGIFY(x)
+
+// ============================================================================================================
+// ==========          OutOfProcessBackend                            =========================================
+// ============================================================================================================
+/*
+ * Forwards run() calls to the inference host process (Source/InferenceHost) over shared memory rings.
+ *
+ * The host is launched by load() and relaunched (reloading the model) if it crashes, in which case the failed
+ * call is retried once. A slow call is not a crash: as long as the host process is alive, run() waits for it
+ * (up to inference_settings.inference_host_hang_timeout_ms in settings.json, after which the host is considered
+ * hung and is relaunched too). Calls that still fail, or that the host answers with an error
+ * (i.e. the model threw, or a message doesn't fit in the rings), are logged and return an empty list.
+ * Nothing is thrown, so a broken model or host never takes the plugin down.
+ * Calls are serialized (the rings have a single producer/consumer on each side), so concurrent run() calls
+ * from several threads are safe but not parallel.
+ */
+class OutOfProcessBackend : public InferenceBackend {
+public:
+    explicit OutOfProcessBackend(std::string host_path_) : host_path(std::move(host_path_)) {}
+
+    ~OutOfProcessBackend() override {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopHost();
+    }
+
+    bool load(const std::string& path) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        model_path = path;
+        return startHost();
+    }
+
+    // don't take the mutex (a run() may be in progress on another thread), see loaded and methods
+    [[nodiscard]] bool isLoaded() const override { return loaded; }
+
+    [[nodiscard]] bool hasMethod(const std::string& method) const override {
+        auto current = std::atomic_load(&methods);
+        return std::find(current->begin(), current->end(), method) != current->end();
+    }
+
+    std::vector<torch::Tensor> run(const std::string& method, const std::vector<torch::Tensor>& inputs) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        inference_host::Message request;
+        request.kind = inference_host::Kind::Run;
+        request.text = method;
+        request.tensors = inputs;
+
+        auto response = call(request, run_timeout_ms);
+        if (!response.has_value()) {
+            // crashed or hung, relaunch and retry once
+            num_restarts++;
+            std::cout << "Inference host " << (host.isRunning() ? "hung" : "exited") << ", restarting it (restart #"
+                      << num_restarts << ")" << std::endl;
+            if (!startHost() || !(response = call(request, run_timeout_ms)).has_value()) {
+                std::cout << "OutOfProcessBackend: inference host not responding, " << method << "() failed"
+                          << std::endl;
+                return {};
+            }
+        }
+
+        if (response->status != inference_host::Status::Ok) {
+            std::cout << "OutOfProcessBackend: " << method << "() failed: " << response->text << std::endl;
+            return {};
+        }
+        return response->tensors;
+    }
+
+    void setNumThreads(int num_threads_) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        num_threads = num_threads_;
+        sendNumThreads();
+    }
+
+    [[nodiscard]] std::string getName() const override { return "TorchScript (out-of-process)"; }
+
+private:
+    static constexpr int load_timeout_ms = 30000;
+    // only a guard against a hung host, a crashed one is noticed right away (see call())
+    static constexpr int run_timeout_ms = inference_settings::inference_host_hang_timeout_ms;
+    static constexpr int control_timeout_ms = 1000;
+
+    std::string host_path;
+    std::string model_path;
+    // published for isLoaded()/hasMethod(), which can be called while another thread is restarting the host
+    // (methods is immutable once published, a restart publishes a new list)
+    std::shared_ptr<const std::vector<std::string>> methods = std::make_shared<const std::vector<std::string>>();
+    std::optional<int> num_threads;
+    std::atomic<bool> loaded{false};
+    int num_restarts{0};
+
+    juce::ChildProcess host;
+    SharedMemorySegment segment;
+    SharedMemoryRing requests;
+    SharedMemoryRing responses;
+    uint64_t next_request_id{1};
+    std::vector<uint8_t> buffer;
+    std::mutex mutex;       // held for the duration of each call
+
+    // unique per process and instance (also short enough for macOS)
+    static std::string makeSegmentName() {
+        static std::atomic<int> counter{0};
+        return "nmfx_" + std::to_string(juce::Process::getProcessID()) + "_" + std::to_string(counter++);
+    }
+
+    bool startHost() {
+        stopHost();
+        loaded = false;
+
+        if (!juce::File(host_path).existsAsFile()) {
+            std::cout << "Inference host not found at: " << host_path << std::endl;
+            return false;
+        }
+
+        auto name = makeSegmentName();
+        if (!segment.create(name, inference_host::segmentSize())) {
+            std::cout << "Could not create shared memory segment for the inference host" << std::endl;
+            return false;
+        }
+        auto base = static_cast<uint8_t*>(segment.getData());
+        SharedMemoryRing::initialize(base + inference_host::requestRingOffset(), inference_host::ring_capacity);
+        SharedMemoryRing::initialize(base + inference_host::responseRingOffset(), inference_host::ring_capacity);
+        requests.attach(base + inference_host::requestRingOffset());
+        responses.attach(base + inference_host::responseRingOffset());
+        // published last, the host checks it before attaching to the rings
+        auto header = new (base) inference_host::SegmentHeader();
+        header->capacity = inference_host::ring_capacity;
+        header->magic = inference_host::segment_magic;
+
+        juce::StringArray args{host_path, name, juce::String(juce::Process::getProcessID())};
+        if (!host.start(args, 0)) {      // host output isn't read (0: discarded)
+            std::cout << "Could not launch the inference host" << std::endl;
+            segment.close();
+            return false;
+        }
+
+        inference_host::Message request;
+        request.kind = inference_host::Kind::Load;
+        request.text = model_path;
+        auto response = call(request, load_timeout_ms);
+        if (!response.has_value() || response->status != inference_host::Status::Ok) {
+            std::cout << "Inference host failed to load: " << model_path << std::endl;
+            stopHost();
+            return false;
+        }
+
+        auto loaded_methods = std::make_shared<std::vector<std::string>>();
+        std::stringstream ss(response->text);
+        for (std::string method; std::getline(ss, method, ',');) {
+            if (!method.empty()) { loaded_methods->push_back(method); }
+        }
+        std::atomic_store(&methods, std::shared_ptr<const std::vector<std::string>>(std::move(loaded_methods)));
+        loaded = true;
+
+        if (num_threads.has_value()) {
+            sendNumThreads();
+        }
+        return true;
+    }
+
+    void sendNumThreads() {
+        inference_host::Message request;
+        request.kind = inference_host::Kind::SetNumThreads;
+        request.int_arg = num_threads.value_or(1);
+        call(request, control_timeout_ms);
+    }
+
+    void stopHost() {
+        if (host.isRunning()) {
+            inference_host::Message request;
+            request.kind = inference_host::Kind::Shutdown;
+            call(request, control_timeout_ms);
+            if (!host.waitForProcessToFinish(control_timeout_ms)) {
+                host.kill();
+            }
+        }
+        segment.close();
+    }
+
+    // sends the request and waits for its response, returns nullopt if the host is gone or didn't answer in time
+    // (a request too large for the ring is answered here with an error, the host is fine)
+    std::optional<inference_host::Message> call(inference_host::Message& request, int timeout_ms) {
+        if (!segment.isOpen() || !host.isRunning()) {
+            return std::nullopt;
+        }
+
+        request.request_id = next_request_id++;
+        request.serialize(buffer);
+        if (!inference_host::fitsInRing(buffer.size())) {
+            inference_host::Message response;
+            response.kind = request.kind;
+            response.status = inference_host::Status::Error;
+            response.request_id = request.request_id;
+            response.text = inference_host::messageTooLarge(buffer.size());
+            return response;
+        }
+        if (!requests.write(buffer.data(), (uint32_t) buffer.size())) {
+            return std::nullopt;
+        }
+
+        // waits in short slices, so that a crashed host is noticed right away
+        auto deadline = juce::Time::getMillisecondCounter() + (juce::uint32) timeout_ms;
+        while (juce::Time::getMillisecondCounter() < deadline) {
+            if (!responses.waitForData(20)) {
+                if (!host.isRunning()) {
+                    return std::nullopt;
+                }
+                continue;
+            }
+
+            while (responses.read(buffer)) {
+                inference_host::Message response;
+                // responses to requests that timed out earlier are dropped
+                if (response.deserialize(buffer) && response.request_id == request.request_id) {
+                    return response;
+                }
+            }
+        }
+        return std::nullopt;
+    }
+};
+
+std::shared_ptr<InferenceBackend> createOutOfProcessBackend(const std::string& host_path) {
+    return std::make_shared<OutOfProcessBackend>(host_path);
+}
+
+std::string getDefaultInferenceHostPath() {
+#ifdef DEFAULT_INFERENCE_HOST_PATH
+    auto path = std::string(TOSTRING(DEFAULT_INFERENCE_HOST_PATH));
+    if (path.size() >= 2 && path.front() == '"' && path.back() == '"') {
+        path = path.substr(1, path.size() - 2);
+    }
+    return path;
+#else
+    return "";
+#endif
+}
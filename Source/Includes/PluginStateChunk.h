@@ -0,0 +1,107 @@
+#pragma once
+
+#include "shared_plugin_helpers/shared_plugin_helpers.h"
+#include "TorchScriptAndPresetLoaders.h"
+#include <map>
+#include <optional>
+
+// ============================================================================================================
+// ==========          Plugin State Chunk                             =========================================
+// ============================================================================================================
+/*
+ * Binary chunk saved by the host with the session (getStateInformation / setStateInformation).
+ *
+ * Layout (version 1, little endian, as written by juce::OutputStream::writeInt/writeInt64):
+ *      magic "NMFXSTAT" | uint32 version | uint32 reserved |
+ *      uint64 apvts_size   | apvts state (juce::ValueTree::writeToStream) |
+ *      uint64 tensors_size | CustomPresetData tensors (.preset_data container, see preset_tensor_file)
+ *
+ * Session state must round trip exactly, so the tensors are only ever gzipped (as configured in preset_settings),
+ * never stored as fp16.
+ * Sections are written straight into the host's block (sizes are patched in afterwards), so no intermediate
+ * XML or copies are made. Chunks saved before this format existed (APVTS xml via copyXmlToBinary) don't start
+ * with the magic and are read by the caller as before.
+ */
+namespace plugin_state_chunk {
+    constexpr char magic[8] = {'N', 'M', 'F', 'X', 'S', 'T', 'A', 'T'};
+    constexpr uint32_t version = 1;
+
+    struct State {
+        juce::ValueTree apvts;
+        std::map<std::string, torch::Tensor> tensors;
+    };
+
+    inline bool hasMagic(const void* data, size_t size) {
+        return size >= sizeof(magic) && std::memcmp(data, magic, sizeof(magic)) == 0;
+    }
+
+    // writes [uint64 size][section] at the current position of out
+    template <typename WriteFn>
+    void writeSection(juce::MemoryOutputStream& out, WriteFn&& write_section) {
+        auto size_position = out.getPosition();
+        out.writeInt64(0);
+        write_section();
+        auto end = out.getPosition();
+        out.setPosition(size_position);
+        out.writeInt64(end - size_position - (juce::int64) sizeof(juce::int64));
+        out.setPosition(end);
+    }
+
+    inline void write(const juce::ValueTree& apvts, const std::map<std::string, torch::Tensor>& tensors,
+                      juce::MemoryBlock& dest) {
+        dest.reset();
+        juce::MemoryOutputStream out(dest, false);
+        out.write(magic, sizeof(magic));
+        out.writeInt((int) version);
+        out.writeInt(0);
+        writeSection(out, [&] { apvts.writeToStream(out); });
+        writeSection(out, [&] {
+            auto options = preset_tensor_file::defaultEncodingOptions();
+            preset_tensor_file::write(tensors, out, {options.compression_threshold_bytes, false,
+                                                     options.compression_level});
+        });
+    }
+
+    // returns nullopt if the chunk isn't in this format or is corrupted
+    inline std::optional<State> read(const void* data, size_t size) {
+        if (!hasMagic(data, size)) {
+            return std::nullopt;
+        }
+
+        juce::MemoryInputStream in(data, size, false);
+        in.skipNextBytes(sizeof(magic));
+        auto chunk_version = (uint32_t) in.readInt();
+        in.readInt();
+        if (chunk_version > version) {
+            std::cout << "State chunk was saved by a newer version of the plugin" << std::endl;
+            return std::nullopt;
+        }
+
+        State state;
+        auto apvts_size = in.readInt64();
+        if (apvts_size < 0 || apvts_size > in.getNumBytesRemaining()) {
+            return std::nullopt;
+        }
+        auto apvts_end = in.getPosition() + apvts_size;
+        state.apvts = juce::ValueTree::readFromStream(in);
+        in.setPosition(apvts_end);
+
+        auto tensors_size = in.readInt64();
+        if (tensors_size < 0 || tensors_size > in.getNumBytesRemaining()) {
+            return std::nullopt;
+        }
+        if (tensors_size > 0) {
+            // the host owns data only for the duration of the call, so the container gets its own buffer
+            // (which the loaded tensors keep alive)
+            auto block = std::make_shared<juce::MemoryBlock>(
+                static_cast<const char*>(data) + in.getPosition(), (size_t) tensors_size);
+            auto tensors = preset_tensor_file::parse(
+                static_cast<const uint8_t*>(block->getData()), block->getSize(), block);
+            if (!tensors.has_value()) {
+                return std::nullopt;
+            }
+            state.tensors = std::move(*tensors);
+        }
+        return state;
+    }
+}
@@ -0,0 +1,296 @@
+#pragma once
+
+#include "shared_plugin_helpers/shared_plugin_helpers.h"
+#include "Configs_Parser.h"
+#include "LRUCache.h"
+#include "TorchScriptAndPresetLoaders.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+// ============================================================================================================
+// ==========          PresetCatalog                                  =========================================
+// ============================================================================================================
+/*
+ * Single file index of the preset bank (`preset.catalog.json` in the preset directory), so the preset browser
+ * can be populated from one read instead of touching every <idx>.apvts / <idx>.preset_data pair.
+ *
+ * Per slot it holds the name, the size, content hash and modification time of both files and a tiny thumbnail
+ * of the preset data (thumbnail_size bins of the first tensor, 0..255).
+ *
+ *  - load() is called once when the editor opens (migrates `preset.names` if there is no catalog yet or if it
+ *      is unreadable, entries that can't be parsed are skipped)
+ *  - entries are checked against the files on disk the first time they are needed (i.e. when the row is drawn):
+ *      takeForValidation() hands a batch of them to a background thread which runs revalidate() (hashing both
+ *      files), the refreshed entries come back through applyValidated() and the catalog is saved once per batch
+ *  - the file is always replaced atomically (written to a temporary file, then renamed)
+ *
+ * Only used from the message thread (except for the static describeSlot() and revalidate()).
+ */
+class PresetCatalog {
+public:
+    static constexpr int thumbnail_size = 32;
+
+    struct FileInfo {
+        int64_t size{0};
+        uint64_t hash{0};
+        int64_t modification_time{0};      // ms since epoch
+
+        bool operator==(const FileInfo& other) const {
+            return size == other.size && hash == other.hash && modification_time == other.modification_time;
+        }
+    };
+
+    struct Entry {
+        juce::String name;
+        FileInfo apvts;
+        FileInfo data;
+        std::vector<uint8_t> thumbnail;
+        bool validated{false};             // not persisted
+    };
+
+    explicit PresetCatalog(int num_slots_) : num_slots(num_slots_) {}
+
+    // reads the catalog (or migrates preset.names), returns false if neither exists
+    bool load() {
+        entries.clear();
+        auto file = getCatalogFile();
+        if (file.existsAsFile()) {
+            auto parsed = json::parse(file.loadFileAsString().toStdString(), nullptr, false);
+            if (parsed.is_object() && parsed.contains("version") && parsed["version"].is_number_integer() &&
+                parsed["version"].get<int>() == version && parsed.contains("presets") && parsed["presets"].is_object()) {
+                for (const auto& [key, value] : parsed["presets"].items()) {
+                    auto idx = juce::String(key).getIntValue();
+                    auto entry = fromJson(value);
+                    if (juce::String(idx) == juce::String(key) && idx >= 1 && idx <= num_slots && entry.has_value()) {
+                        entries[idx] = std::move(*entry);
+                    }
+                }
+                return true;
+            }
+        }
+        return migrateFromPresetNames();
+    }
+
+    [[nodiscard]] juce::String getName(int idx) const {
+        auto it = entries.find(idx);
+        return it != entries.end() ? it->second.name : juce::String("---");
+    }
+
+    [[nodiscard]] const std::vector<uint8_t>& getThumbnail(int idx) const {
+        static const std::vector<uint8_t> empty;
+        auto it = entries.find(idx);
+        return it != entries.end() ? it->second.thumbnail : empty;
+    }
+
+    void setName(int idx, const juce::String& name) {
+        entries[idx].name = name;
+        save();
+    }
+
+    // file stats, hashes and thumbnail of a slot (doesn't touch the catalog, so it can run on any thread)
+    static Entry describeSlot(int idx, const std::map<std::string, torch::Tensor>& tensors) {
+        Entry entry;
+        entry.apvts = describe(getApvtsFile(idx));
+        entry.data = describe(getDataFile(idx));
+        entry.thumbnail = makeThumbnail(tensors);
+        entry.validated = true;
+        return entry;
+    }
+
+    // called after the preset files are written (with the result of describeSlot(), the name is kept)
+    void update(int idx, Entry described) {
+        described.name = getName(idx);
+        described.validated = true;
+        entries[idx] = std::move(described);
+        save();
+    }
+
+    [[nodiscard]] bool needsValidation(int idx) const {
+        auto it = entries.find(idx);
+        return it != entries.end() && !it->second.validated;
+    }
+
+    // copies of the given entries that haven't been checked yet (they are marked as checked)
+    std::vector<std::pair<int, Entry>> takeForValidation(const std::vector<int>& indices) {
+        std::vector<std::pair<int, Entry>> batch;
+        for (auto idx : indices) {
+            if (needsValidation(idx)) {
+                entries[idx].validated = true;
+                batch.emplace_back(idx, entries[idx]);
+            }
+        }
+        return batch;
+    }
+
+    // checks an entry against the files on disk (size + modification time, hashes only if they differ)
+    // returns the refreshed entry if the files were modified outside the plugin (can run on any thread)
+    static std::optional<Entry> revalidate(int idx, const Entry& entry) {
+        auto apvts_file = getApvtsFile(idx);
+        auto data_file = getDataFile(idx);
+        if (isUnchanged(entry.apvts, apvts_file) && isUnchanged(entry.data, data_file)) {
+            return std::nullopt;
+        }
+
+        Entry refreshed = entry;
+        refreshed.apvts = describe(apvts_file);
+        refreshed.data = describe(data_file);
+        if (refreshed.apvts == entry.apvts && refreshed.data == entry.data) {
+            return std::nullopt;
+        }
+        if (refreshed.data.hash != entry.data.hash) {
+            refreshed.thumbnail = data_file.existsAsFile() ? makeThumbnail(load_tensor_map(getDataFileName(idx)))
+                                                           : std::vector<uint8_t>();
+        }
+        return refreshed;
+    }
+
+    // applies the entries refreshed by revalidate() (names are kept, they may have changed meanwhile)
+    // the catalog is saved once for the whole batch
+    void applyValidated(std::vector<std::pair<int, Entry>> refreshed) {
+        for (auto& [idx, entry] : refreshed) {
+            entry.name = getName(idx);
+            entry.validated = true;
+            entries[idx] = std::move(entry);
+        }
+        if (!refreshed.empty()) {
+            save();
+        }
+    }
+
+    // downsamples the first (non empty) tensor to thumbnail_size bins of mean absolute value
+    static std::vector<uint8_t> makeThumbnail(const std::map<std::string, torch::Tensor>& tensors) {
+        for (const auto& [key, t] : tensors) {
+            if (!t.defined() || t.numel() == 0) {
+                continue;
+            }
+            auto values = t.detach().flatten().to(torch::kFloat).abs();
+            auto bins = std::min<int64_t>(thumbnail_size, values.numel());
+            std::vector<float> means;
+            for (const auto& chunk : torch::tensor_split(values, bins)) {     // bins may differ in size by one
+                means.push_back(chunk.mean().item<float>());
+            }
+            auto max = *std::max_element(means.begin(), means.end());
+            std::vector<uint8_t> thumbnail;
+            for (auto mean : means) {
+                thumbnail.push_back((uint8_t) std::lround((max > 0 ? mean / max : 0.0f) * 255));
+            }
+            return thumbnail;
+        }
+        return {};
+    }
+
+private:
+    static constexpr int version = 1;
+
+    int num_slots;
+    std::map<int, Entry> entries;
+
+    static juce::File getPresetDir() { return juce::File(stripQuotes(default_preset_dir)); }
+    static juce::File getCatalogFile() { return getPresetDir().getChildFile("preset.catalog.json"); }
+    static juce::File getApvtsFile(int idx) { return getPresetDir().getChildFile(std::to_string(idx) + ".apvts"); }
+    static std::string getDataFileName(int idx) { return std::to_string(idx) + ".preset_data"; }
+    static juce::File getDataFile(int idx) { return getPresetDir().getChildFile(getDataFileName(idx)); }
+
+    static bool isUnchanged(const FileInfo& info, const juce::File& file) {
+        if (!file.existsAsFile()) {
+            return info.size == 0 && info.modification_time == 0;
+        }
+        return info.size == file.getSize() && info.modification_time == file.getLastModificationTime().toMilliseconds();
+    }
+
+    static FileInfo describe(const juce::File& file) {
+        FileInfo info;
+        if (!file.existsAsFile()) {
+            return info;
+        }
+        juce::MemoryBlock content;
+        file.loadFileAsData(content);
+        info.size = (int64_t) content.getSize();
+        info.hash = hash_bytes(content.getData(), content.getSize());
+        info.modification_time = file.getLastModificationTime().toMilliseconds();
+        return info;
+    }
+
+    // names of a bank saved before the catalog existed (one per line, slot 1 first)
+    bool migrateFromPresetNames() {
+        auto names_file = getPresetDir().getChildFile("preset.names");
+        if (!names_file.existsAsFile()) {
+            return false;
+        }
+        juce::StringArray names;
+        names_file.readLines(names);
+        for (int i = 0; i < names.size() && i < num_slots; i++) {
+            entries[i + 1].name = names[i];     // stats, hashes and thumbnails are filled in by revalidate()
+        }
+        save();
+        return true;
+    }
+
+    void save() const {
+        json presets = json::object();
+        for (const auto& [idx, entry] : entries) {
+            presets[std::to_string(idx)] = toJson(entry);
+        }
+        json catalog = {{"version", version}, {"presets", presets}};
+
+        auto file = getCatalogFile();
+        file.getParentDirectory().createDirectory();
+        juce::TemporaryFile temp(file);
+        if (!temp.getFile().replaceWithText(catalog.dump(1)) || !temp.overwriteTargetFileWithTemporary()) {
+            std::cout << "Failed to save preset catalog: " << file.getFullPathName() << std::endl;
+        }
+    }
+
+    static json toJson(const FileInfo& info) {
+        // hashes as hex strings, json numbers aren't guaranteed to hold 64 bits
+        return {{"size", info.size},
+                {"hash", juce::String::toHexString((juce::int64) info.hash).toStdString()},
+                {"modified", info.modification_time}};
+    }
+
+    static FileInfo fileInfoFromJson(const json& j) {
+        FileInfo info;
+        if (!j.is_object()) {
+            return info;
+        }
+        info.size = j.value("size", (int64_t) 0);
+        info.hash = (uint64_t) juce::String(j.value("hash", std::string())).getHexValue64();
+        info.modification_time = j.value("modified", (int64_t) 0);
+        return info;
+    }
+
+    static json toJson(const Entry& entry) {
+        return {{"name", entry.name.toStdString()},
+                {"apvts", toJson(entry.apvts)},
+                {"data", toJson(entry.data)},
+                {"thumbnail", entry.thumbnail}};
+    }
+
+    // nullopt if the entry is malformed (wrong types, thumbnail values out of range, ...)
+    static std::optional<Entry> fromJson(const json& j) {
+        if (!j.is_object()) {
+            return std::nullopt;
+        }
+        try {
+            Entry entry;
+            entry.name = juce::String(j.value("name", std::string("---")));
+            entry.apvts = fileInfoFromJson(j.value("apvts", json()));
+            entry.data = fileInfoFromJson(j.value("data", json()));
+            for (const auto& value : j.value("thumbnail", json::array())) {
+                auto bin = value.get<int>();
+                if (bin < 0 || bin > 255) {
+                    return std::nullopt;
+                }
+                entry.thumbnail.push_back((uint8_t) bin);
+            }
+            return entry;
+        } catch (const json::exception&) {
+            return std::nullopt;
+        }
+    }
+};
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "shared_plugin_helpers/shared_plugin_helpers.h"
+#include "LRUCache.h"
+#include "TorchScriptAndPresetLoaders.h"
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <optional>
+
+// ============================================================================================================
+// ==========          PresetLoaderThread                             =========================================
+// ============================================================================================================
+/*
+ * Loads presets (<idx>.apvts + its tensor data) in the background, so that the APVTSMediatorThread never blocks
+ * on file IO or XML parsing.
+ *
+ * request(idx) is latest wins: the loader loads the latest requested preset, makes it available through
+ * takeLoaded(), then prefetches the neighbouring presets (idx-1, idx+1) so that stepping through presets is
+ * served from the cache. Parsed presets are kept in an LRU cache and reloaded if their files changed on disk
+ * (i.e. the preset was saved again).
+ */
+class PresetLoaderThread : public juce::Thread {
+public:
+    struct LoadedPreset {
+        int index{-1};
+        juce::ValueTree state;                          // parsed apvts state (copy it before handing it over)
+        std::map<std::string, torch::Tensor> tensors;
+        juce::Time apvts_modification_time;
+        juce::Time data_modification_time;
+    };
+
+    // presets are numbered first_preset_ ... last_preset_ (range of the Preset parameter)
+    PresetLoaderThread(juce::Identifier state_type_, int first_preset_, int last_preset_, size_t cache_capacity = 8) :
+        juce::Thread("PresetLoaderThread"), state_type(std::move(state_type_)),
+        first_preset(first_preset_), last_preset(last_preset_), cache(cache_capacity) {}
+
+    ~PresetLoaderThread() override {
+        prepareToStop();
+    }
+
+    // asks for a preset to be loaded (replaces any pending request)
+    void request(int preset_idx) {
+        requested_idx = preset_idx;
+        if (!isThreadRunning()) {
+            startThread(juce::Thread::Priority::low);
+        }
+        notify();
+    }
+
+    // drops the pending request (and a loaded preset that wasn't taken yet)
+    void cancel() {
+        requested_idx = -1;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            loaded = std::nullopt;
+        }
+        notify();
+    }
+
+    // returns the requested preset once it is loaded (only once), nullopt if not ready (or missing on disk)
+    std::optional<LoadedPreset> takeLoaded() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!loaded.has_value() || loaded->index != requested_idx) {
+            return std::nullopt;
+        }
+        auto preset = std::move(loaded);
+        loaded = std::nullopt;
+        return preset;
+    }
+
+    [[nodiscard]] uint64_t getNumCacheHits() const { return cache.getNumHits(); }
+    [[nodiscard]] uint64_t getNumCacheMisses() const { return cache.getNumMisses(); }
+
+    void run() override {
+        int served_idx = -1;
+        while (!threadShouldExit()) {
+            auto idx = requested_idx.load();
+            if (idx == served_idx) {
+                wait(-1);
+                continue;
+            }
+            served_idx = idx;
+            if (idx < 0) {
+                continue;
+            }
+
+            auto preset = getOrLoad(idx);
+            if (preset.has_value()) {
+                std::lock_guard<std::mutex> lock(mutex);
+                loaded = std::move(preset);
+            }
+
+            // prefetch the neighbours (unless a new preset was requested in the meantime)
+            for (auto neighbour : {idx + 1, idx - 1}) {
+                if (requested_idx != idx || threadShouldExit()) {
+                    break;
+                }
+                if (neighbour >= first_preset && neighbour <= last_preset) {
+                    getOrLoad(neighbour);
+                }
+            }
+        }
+    }
+
+    void prepareToStop() {
+        signalThreadShouldExit();
+        notify();
+        stopThread(1000);
+    }
+
+private:
+    juce::Identifier state_type;
+    int first_preset;
+    int last_preset;
+    LRUCache<int, LoadedPreset> cache;
+
+    std::atomic<int> requested_idx{-1};
+    std::mutex mutex;
+    std::optional<LoadedPreset> loaded;
+
+    static juce::File getApvtsFile(int idx) {
+        return juce::File(stripQuotes(default_preset_dir) + path_separator + std::to_string(idx) + ".apvts");
+    }
+
+    static juce::File getDataFile(const std::string& file_name) {
+        return juce::File(stripQuotes(default_preset_dir) + path_separator + file_name);
+    }
+
+    // returns the cached preset if its files haven't changed, otherwise (re)loads it from disk
+    std::optional<LoadedPreset> getOrLoad(int idx) {
+        auto apvts_file = getApvtsFile(idx);
+        if (!apvts_file.existsAsFile()) {
+            return std::nullopt;
+        }
+
+        if (auto cached = cache.get(idx)) {
+            auto data_file = getDataFile(cached->state.getProperty("filePath").toString().toStdString());
+            if (cached->apvts_modification_time == apvts_file.getLastModificationTime() &&
+                cached->data_modification_time == data_file.getLastModificationTime()) {
+                return cached;
+            }
+        }
+
+        auto xml = juce::XmlDocument::parse(apvts_file);
+        if (xml == nullptr || !xml->hasTagName(state_type)) {
+            return std::nullopt;
+        }
+
+        LoadedPreset preset;
+        preset.index = idx;
+        preset.apvts_modification_time = apvts_file.getLastModificationTime();
+        preset.state = juce::ValueTree::fromXml(*xml);
+
+        auto data_file_name = xml->getStringAttribute("filePath").toStdString();
+        preset.data_modification_time = getDataFile(data_file_name).getLastModificationTime();
+        preset.tensors = load_tensor_map(data_file_name);
+        if (debugging_settings::APVTSMediatorThread::benchmark_preset_encodings && !preset.tensors.empty()) {
+            std::cout << "Preset " << idx << ": " << preset_tensor_file::benchmark(preset.tensors);
+        }
+
+        cache.put(idx, preset);
+        return preset;
+    }
+};
@@ -2,12 +2,15 @@
 
 #include <array>
 #include "shared_plugin_helpers/shared_plugin_helpers.h"
+#include "PresetCatalog.h"
+#include "PresetWriterThread.h"
 
 #pragma once
 
 class PresetTableComponent : public juce::Component,
                              public juce::TableListBoxModel,
-                             private juce::Slider::Listener
+                             private juce::Slider::Listener,
+                             private juce::Timer
 {
 public:
     explicit PresetTableComponent(juce::AudioProcessorValueTreeState& apvts_,
@@ -59,12 +62,52 @@ public:
 
     void paintCell(juce::Graphics& g, int rowNumber, int /*columnId*/, int width, int height, bool /*rowIsSelected*/) override
     {
+        // files are only checked against the catalog once a row is shown (in the background, in batches)
+        if (catalog.needsValidation(rowNumber + 1)) {
+            rowsToValidate.push_back(rowNumber + 1);
+            if (!isTimerRunning()) {
+                startTimer(validation_batch_delay_ms);
+            }
+        }
+
+        // thumbnail of the preset data on the right
+        const auto& thumbnail = catalog.getThumbnail(rowNumber + 1);
+        auto text_width = width - 4;
+        if (!thumbnail.empty()) {
+            auto thumbnail_width = juce::jmin(width / 3, (int) thumbnail.size() * 2);
+            auto bar_width = (float) thumbnail_width / (float) thumbnail.size();
+            auto x0 = (float) (width - thumbnail_width - 2);
+            g.setColour(juce::Colours::darkgrey);
+            for (size_t i = 0; i < thumbnail.size(); i++) {
+                auto bar_height = (float) (height - 4) * (float) thumbnail[i] / 255.0f;
+                g.fillRect(x0 + bar_width * (float) i, (float) height - 2 - bar_height, bar_width, bar_height);
+            }
+            text_width -= thumbnail_width + 4;
+        }
+
         g.setColour(juce::Colours::black);
-        g.drawText(presetNames[rowNumber], 2, 0, width - 4, height, juce::Justification::centredLeft, true);
+        g.drawText(presetNames[rowNumber], 2, 0, text_width, height, juce::Justification::centredLeft, true);
     }
 
     ~PresetTableComponent() override = default;
 
+    // hands the rows drawn since the last call to the presetWriter
+    void timerCallback() override
+    {
+        stopTimer();
+        presetWriter.validate(catalog.takeForValidation(rowsToValidate));
+        rowsToValidate.clear();
+    }
+
+    // called on the message thread with the entries whose files were modified outside the plugin
+    void presetsValidated(std::vector<std::pair<int, PresetCatalog::Entry>> entries)
+    {
+        std::vector<int> rows;
+        for (const auto& [idx, entry] : entries) { rows.push_back(idx - 1); }
+        catalog.applyValidated(std::move(entries));
+        for (auto row : rows) { presetTables[0].repaintRow(row); }
+    }
+
     void resized() override
     {
         auto gap = proportionOfHeight(0.03f);
@@ -106,25 +149,20 @@ public:
 
     }
 
-    // save preset names to a file
-    void savePresetNames()
+    // save the name of the selected row to the catalog
+    void savePresetName(int row)
     {
-        juce::File presetNamesFile(
-            stripQuotes(std::string(default_preset_dir)) + path_separator + "preset.names");
-        presetNamesFile.deleteFile();
-        presetNamesFile.create();
-        presetNamesFile.appendText(presetNames.joinIntoString("\n"));
+        catalog.setName(row + 1, presetNames[row]);
     }
 
+    // read once when the editor opens (the catalog replaces the old preset.names file)
     void loadPresetNames()
     {
-        juce::File presetNamesFile(
-            stripQuotes(std::string(default_preset_dir)) + path_separator + "preset.names");
-
-        if (presetNamesFile.existsAsFile())
+        if (catalog.load())
         {
-            presetNames.clear();
-            presetNamesFile.readLines(presetNames);
+            for (int row = 0; row < presetNames.size(); ++row) {
+                presetNames.set(row, catalog.getName(row + 1));
+            }
         }
     }
 
@@ -155,25 +193,25 @@ public:
         // moved to APVTSMediatorThread
     }*/
 
+    // snapshots the state and the preset data, the files are written by the presetWriter
     void savePreset()
     {
-        // Step 1: Get the ValueTree from APVTS
-        auto state = apvts.copyState();
-
-        // Step 2: Serialize the ValueTree to XML
-        std::unique_ptr<juce::XmlElement> xml(state.createXml());
-
-        // Step 3: Write the XML to the file
         auto preset_idx = (int) currentPresetSlider.getValue();
-        std::string fp = stripQuotes(default_preset_dir) + path_separator + std::to_string(preset_idx) + ".apvts";
-        std::string fp_data = std::to_string(preset_idx) + ".preset_data";
-
-        // Step 4: Add the file path as an attribute
-        xml->setAttribute("filePath", fp_data); // Add the file path as an attribute
+        // doesn't mark the data as read
+        presetWriter.save(preset_idx, {apvts.copyState(), CustomPresetData->snapshot()});
+        numPendingSaves++;
+        saveButton.setButtonText("Saving...");
+    }
 
-        // save to files
-        save_tensor_map(CustomPresetData->tensors(), fp_data);
-        xml->writeTo(juce::File(fp), {}); // Write the XML to the file
+    // called on the message thread once the presetWriter is done with a preset
+    void presetSaved(int preset_idx, bool success, PresetCatalog::Entry entry)
+    {
+        numPendingSaves--;
+        if (success) {
+            catalog.update(preset_idx, std::move(entry));
+            presetTables[0].repaintRow(preset_idx - 1);
+        }
+        saveButton.setButtonText(!success ? "Save failed" : (numPendingSaves > 0 ? "Saving..." : "Save"));
     }
 
     void renamePreset()
@@ -185,6 +223,7 @@ public:
                 auto selectedRow = table.getSelectedRow();
                 presetNames.set(selectedRow, "Preset " + juce::String(selectedRow + 1));
                 table.updateContent();
+                savePresetName(selectedRow);
                 break;
             }
 
@@ -192,11 +231,10 @@ public:
                 auto selectedRow = table.getSelectedRow();
                 presetNames.set(selectedRow, presetNameEditor.getText());
                 table.updateContent();
+                savePresetName(selectedRow);
                 break;
             }
         }
-
-        savePresetNames();
     }
 
     // listen to slider changes
@@ -219,6 +257,7 @@ private:
 
     std::array<juce::TableListBox, 1> presetTables;
     juce::StringArray presetNames;
+    PresetCatalog catalog{100};
     juce::TextButton saveButton;
     juce::TextEditor presetNameEditor; // Added text editor for preset names
     juce::AudioProcessorValueTreeState& apvts;
@@ -226,5 +265,21 @@ private:
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> currentPresetSliderAttachment;
 
     bool startUp = true;
+
+    static constexpr int validation_batch_delay_ms = 100;
+    std::vector<int> rowsToValidate;
+
+    int numPendingSaves{0};
+    // declared last, so that pending saves are finished before the rest is destroyed
+    // (the callbacks are dropped if the widget is gone by the time a save/check completes)
+    PresetWriterThread presetWriter{
+        [safe_this = juce::Component::SafePointer<PresetTableComponent>(this)]
+        (int idx, bool success, PresetCatalog::Entry entry) {
+            if (safe_this != nullptr) { safe_this->presetSaved(idx, success, std::move(entry)); }
+        },
+        [safe_this = juce::Component::SafePointer<PresetTableComponent>(this)]
+        (std::vector<std::pair<int, PresetCatalog::Entry>> entries) {
+            if (safe_this != nullptr) { safe_this->presetsValidated(std::move(entries)); }
+        }};
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PresetTableComponent)
 };
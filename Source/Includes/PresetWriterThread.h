@@ -0,0 +1,162 @@
+#pragma once
+
+#include "shared_plugin_helpers/shared_plugin_helpers.h"
+#include "PresetCatalog.h"
+#include "TorchScriptAndPresetLoaders.h"
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+// ============================================================================================================
+// ==========          PresetWriterThread                             =========================================
+// ============================================================================================================
+/*
+ * Writes presets (<idx>.apvts + <idx>.preset_data) in the background, so that saving a large preset never
+ * blocks the editor.
+ *
+ * save() only takes cheap snapshots (a copy of the apvts state and the current CustomPresetData snapshot).
+ * Both files are written to temporary files and renamed over the previous ones, so a crash mid-save leaves the
+ * previous preset intact. Once done, on_saved(idx, success, catalog entry) is called on the message thread
+ * (the entry, see PresetCatalog::describeSlot, is also computed here since it hashes both files).
+ * Saves to a slot that is still waiting to be written replace the pending one.
+ *
+ * Also checks catalog entries against the files on disk (validate(), see PresetCatalog::revalidate), so that
+ * hashing the presets never blocks the editor either. Checks run after the pending saves (a slot is never
+ * hashed while being written), the refreshed entries of a batch are passed to on_validated(entries) on the
+ * message thread. Pending checks are dropped when stopping.
+ */
+class PresetWriterThread : public juce::Thread {
+public:
+    using SavedCallback = std::function<void(int preset_idx, bool success, PresetCatalog::Entry entry)>;
+    using ValidatedCallback = std::function<void(std::vector<std::pair<int, PresetCatalog::Entry>> entries)>;
+
+    struct Job {
+        juce::ValueTree state;
+        std::shared_ptr<const CustomPresetDataDictionary::Snapshot> data;
+    };
+
+    PresetWriterThread(SavedCallback on_saved_, ValidatedCallback on_validated_) :
+        juce::Thread("PresetWriterThread"), on_saved(std::move(on_saved_)), on_validated(std::move(on_validated_)) {}
+
+    ~PresetWriterThread() override {
+        // pending saves are finished (not dropped) before stopping
+        signalThreadShouldExit();
+        notify();
+        stopThread(-1);
+    }
+
+    void save(int preset_idx, Job job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending[preset_idx] = std::move(job);
+        }
+        startIfNeeded();
+    }
+
+    // queues a batch of entries (see PresetCatalog::takeForValidation) to be checked against the files
+    void validate(std::vector<std::pair<int, PresetCatalog::Entry>> batch) {
+        if (batch.empty()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending_validations.push_back(std::move(batch));
+        }
+        startIfNeeded();
+    }
+
+    void run() override {
+        while (true) {
+            std::optional<std::pair<int, Job>> job;
+            std::vector<std::pair<int, PresetCatalog::Entry>> batch;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!pending.empty()) {
+                    job = std::move(*pending.begin());
+                    pending.erase(pending.begin());
+                } else if (!pending_validations.empty() && !threadShouldExit()) {
+                    batch = std::move(pending_validations.front());
+                    pending_validations.pop_front();
+                }
+            }
+
+            if (!batch.empty()) {
+                validateBatch(batch);
+                continue;
+            }
+
+            if (!job.has_value()) {
+                if (threadShouldExit()) {
+                    return;
+                }
+                wait(-1);
+                continue;
+            }
+
+            auto idx = job->first;
+            auto success = write(idx, job->second);
+            auto entry = success ? PresetCatalog::describeSlot(idx, job->second.data->tensors) : PresetCatalog::Entry();
+
+            // the callback is copied into the message thread call, which may run after this thread is gone
+            juce::MessageManager::callAsync([callback = on_saved, idx, success, entry = std::move(entry)]() mutable {
+                if (callback) { callback(idx, success, std::move(entry)); }
+            });
+        }
+    }
+
+private:
+    SavedCallback on_saved;
+    ValidatedCallback on_validated;
+    std::mutex mutex;
+    std::map<int, Job> pending;
+    std::deque<std::vector<std::pair<int, PresetCatalog::Entry>>> pending_validations;
+
+    void startIfNeeded() {
+        if (!isThreadRunning()) {
+            startThread(juce::Thread::Priority::low);
+        }
+        notify();
+    }
+
+    void validateBatch(const std::vector<std::pair<int, PresetCatalog::Entry>>& batch) {
+        std::vector<std::pair<int, PresetCatalog::Entry>> refreshed;
+        for (const auto& [idx, entry] : batch) {
+            if (auto updated = PresetCatalog::revalidate(idx, entry)) {
+                refreshed.emplace_back(idx, std::move(*updated));
+            }
+        }
+        if (refreshed.empty()) {
+            return;
+        }
+        juce::MessageManager::callAsync([callback = on_validated, refreshed = std::move(refreshed)]() mutable {
+            if (callback) { callback(std::move(refreshed)); }
+        });
+    }
+
+    static bool write(int idx, const Job& job) {
+        auto fp_data = std::to_string(idx) + ".preset_data";
+        juce::File apvts_file(stripQuotes(default_preset_dir) + path_separator + std::to_string(idx) + ".apvts");
+
+        // data first, the .apvts file names it
+        if (!save_tensor_map(job.data->tensors, fp_data)) {
+            return false;
+        }
+
+        std::unique_ptr<juce::XmlElement> xml(job.state.createXml());
+        if (xml == nullptr) {
+            return false;
+        }
+        xml->setAttribute("filePath", fp_data);
+
+        juce::TemporaryFile temp(apvts_file);
+        if (!xml->writeTo(temp.getFile(), {}) || !temp.overwriteTargetFileWithTemporary()) {
+            std::cout << "Failed to save preset to: " << apvts_file.getFullPathName() << std::endl;
+            return false;
+        }
+        return true;
+    }
+};
@@ -0,0 +1,281 @@
+#pragma once
+
+#include "InputEvent.h"
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <optional>
+#include <sstream>
+
+// ============================================================================================================
+// ==========          RegenerationScheduler                          =========================================
+// ============================================================================================================
+/*
+ * Decides WHEN a regeneration should run, based on the musical time of the host (BufferMetaData).
+ *
+ * Requests are latest wins: requesting while a request is pending doesn't queue anything, the pending request
+ * is simply run with the latest inputs once its slot comes. A pending request is run when the playhead
+ * crosses the next boundary of the selected cadence:
+ *
+ *      Immediate      : as soon as requested (or whenever the host is not playing)
+ *      EveryNBeats    : every N beats (beat length follows the time signature denominator)
+ *      BarLines       : at every bar line
+ *      BeforeLoopEnd  : one beat before the loop end (falls back to BarLines if the host isn't looping)
+ *
+ * Each run gets a deadline (the boundary following the one at which it ran, or the loop end. Runs of the Immediate
+ * cadence have none and are always applied right away). registerResultReady() checks whether the result was
+ * ready before the deadline:
+ *      - on time : the result can be applied right away
+ *      - missed  : the result should be held back (the previous pattern keeps playing) and released just before
+ *                  the next boundary, see shouldReleaseHeldResult(). Misses are counted and the overrun (in beats)
+ *                  is accumulated in a histogram
+ *
+ * Only the DeploymentThread should call the non-const methods (request() is also safe from other threads).
+ */
+class RegenerationScheduler {
+public:
+    enum class Cadence { Immediate, EveryNBeats, BarLines, BeforeLoopEnd };
+
+    RegenerationScheduler() = default;
+
+    void setCadence(Cadence cadence_, double num_beats_ = 1.0) {
+        cadence = cadence_;
+        num_beats = num_beats_ > 0 ? num_beats_ : 1.0;
+        last_ppq = std::nullopt;
+    }
+
+    // maps the items of the "Regeneration Cadence" comboBox to a cadence
+    void setCadenceFromText(const std::string &text) {
+        if (text == "Every Beat") { setCadence(Cadence::EveryNBeats, 1); }
+        else if (text == "Every 2 Beats") { setCadence(Cadence::EveryNBeats, 2); }
+        else if (text == "Every Bar") { setCadence(Cadence::BarLines); }
+        else if (text == "Before Loop End") { setCadence(Cadence::BeforeLoopEnd); }
+        else { setCadence(Cadence::Immediate); }
+    }
+
+    [[nodiscard]] Cadence getCadence() const { return cadence; }
+
+    // marks a regeneration as pending (replaces any pending request)
+    // shouldRunNow() is only polled while something is pending, so the playhead position seen at the last poll
+    // can be bars old by the time a new request comes in: boundary tracking restarts from the next poll
+    void request() {
+        if (!pending.exchange(true)) {
+            restart_tracking = true;
+        }
+    }
+
+    void cancel() { pending = false; }
+
+    [[nodiscard]] bool isPending() const { return pending; }
+
+    // call once per DPL iteration with the latest playback info
+    // returns true if the pending request should run now (the request is consumed)
+    bool shouldRunNow(const BufferMetaData &info) {
+        bool crossed = crossedBoundary(info);
+
+        if (!pending) {
+            return false;
+        }
+
+        if (!info.isPlaying || info.time_in_ppq < 0) {
+            pending = false;
+            target_ppq = std::nullopt;
+            return true;
+        }
+
+        // Immediate runs have no deadline, so their results are never held back (as before the scheduler)
+        if (cadence == Cadence::Immediate) {
+            pending = false;
+            target_ppq = std::nullopt;
+            return true;
+        }
+
+        if (crossed) {
+            pending = false;
+            target_ppq = nextTarget(info);
+            return true;
+        }
+
+        return false;
+    }
+
+    // call once the result of a run is ready
+    // returns true if it can be applied now, false if it missed its deadline and should be held back
+    bool registerResultReady(const BufferMetaData &info) {
+        if (!target_ppq.has_value()) {
+            return true;
+        }
+
+        auto deadline = *target_ppq;
+        target_ppq = std::nullopt;
+
+        // playhead wrapped/relocated while inferring, the deadline doesn't mean anything anymore
+        if (!info.isPlaying || info.time_in_ppq < 0 || info.time_in_ppq < deadline - 2 * barLength(info)) {
+            return true;
+        }
+
+        if (info.time_in_ppq <= deadline) {
+            num_on_time++;
+            held_release_ppq = std::nullopt;   // supersedes any held result
+            return true;
+        }
+
+        num_late++;
+        auto overrun_in_beats = (info.time_in_ppq - deadline) / beatLength(info);
+        overrun_histogram[overrunBin(overrun_in_beats)]++;
+
+        // hold until just before the next bar line (or the loop end)
+        held_release_ppq = nextHoldRelease(info);
+        held_ppq = info.time_in_ppq;
+        return false;
+    }
+
+    [[nodiscard]] bool hasHeldResult() const { return held_release_ppq.has_value(); }
+
+    // returns true (once) when a held result should be applied
+    bool shouldReleaseHeldResult(const BufferMetaData &info) {
+        if (!held_release_ppq.has_value()) {
+            return false;
+        }
+
+        // release right away if the playhead stopped, jumped back or reached the release point
+        if (!info.isPlaying || info.time_in_ppq < 0 || info.time_in_ppq < held_ppq ||
+            info.time_in_ppq >= *held_release_ppq - release_lead_in_beats * beatLength(info)) {
+            held_release_ppq = std::nullopt;
+            return true;
+        }
+
+        held_ppq = info.time_in_ppq;
+        return false;
+    }
+
+    [[nodiscard]] uint64_t getNumOnTime() const { return num_on_time; }
+    [[nodiscard]] uint64_t getNumLate() const { return num_late; }
+
+    // overrun histogram (in beats): [0, 0.25), [0.25, 0.5), [0.5, 1), [1, 2), [2, 4), [4, inf)
+    static constexpr int num_overrun_bins = 6;
+    [[nodiscard]] std::array<uint64_t, num_overrun_bins> getOverrunHistogram() const {
+        std::array<uint64_t, num_overrun_bins> histogram{};
+        for (int i = 0; i < num_overrun_bins; i++) { histogram[i] = overrun_histogram[i]; }
+        return histogram;
+    }
+
+    [[nodiscard]] std::string getDeadlineReport() const {
+        static const char* bin_labels[num_overrun_bins] = {"<1/4", "<1/2", "<1", "<2", "<4", ">=4"};
+        std::stringstream ss;
+        ss << "Regeneration deadlines | on time: " << num_on_time << " | missed: " << num_late
+           << " | overrun (beats):";
+        for (int i = 0; i < num_overrun_bins; i++) {
+            ss << " " << bin_labels[i] << ": " << overrun_histogram[i];
+        }
+        return ss.str();
+    }
+
+private:
+    Cadence cadence{Cadence::Immediate};
+    double num_beats{1.0};
+
+    std::atomic<bool> pending{false};
+    std::atomic<bool> restart_tracking{false};  // set by request() when going from idle to pending
+    std::optional<double> last_ppq;
+    std::optional<double> target_ppq;            // deadline of the last run
+    std::optional<double> held_release_ppq;      // set while a result is held back
+    double held_ppq{0};
+    static constexpr double release_lead_in_beats = 0.25;  // held results are released a 16th before the boundary
+
+    std::atomic<uint64_t> num_on_time{0};
+    std::atomic<uint64_t> num_late{0};
+    std::atomic<uint64_t> overrun_histogram[num_overrun_bins]{};
+
+    static int overrunBin(double overrun_in_beats) {
+        if (overrun_in_beats < 0.25) { return 0; }
+        if (overrun_in_beats < 0.5) { return 1; }
+        if (overrun_in_beats < 1) { return 2; }
+        if (overrun_in_beats < 2) { return 3; }
+        if (overrun_in_beats < 4) { return 4; }
+        return 5;
+    }
+
+    static double beatLength(const BufferMetaData &info) {
+        return info.denominator > 0 ? 4.0 / info.denominator : 1.0;
+    }
+
+    static double barLength(const BufferMetaData &info) {
+        return info.numerator > 0 ? info.numerator * beatLength(info) : 4.0;
+    }
+
+    static bool isLooping(const BufferMetaData &info) {
+        return info.isLooping && info.loop_end_in_ppq > info.loop_start_in_ppq;
+    }
+
+    // boundaries are grid points of size period, aligned to origin
+    static double boundaryIndex(double ppq, double origin, double period) {
+        return std::floor((ppq - origin) / period);
+    }
+
+    double period(const BufferMetaData &info) const {
+        if (cadence == Cadence::EveryNBeats) { return num_beats * beatLength(info); }
+        return barLength(info);
+    }
+
+    double origin(const BufferMetaData &info) const {
+        if (cadence == Cadence::EveryNBeats) { return 0.0; }
+        return info.ppq_position_of_last_bar_start >= 0 ? info.ppq_position_of_last_bar_start : 0.0;
+    }
+
+    // returns true if the playhead crossed a boundary of the cadence since the last call
+    bool crossedBoundary(const BufferMetaData &info) {
+        if (restart_tracking.exchange(false)) {
+            last_ppq = std::nullopt;
+        }
+
+        if (!info.isPlaying || info.time_in_ppq < 0) {
+            last_ppq = std::nullopt;
+            return false;
+        }
+
+        auto ppq = info.time_in_ppq;
+        auto prev = last_ppq;
+        last_ppq = ppq;
+
+        if (!prev.has_value()) {
+            return false;
+        }
+
+        // playhead moved backwards (loop wrap or relocation)
+        if (ppq < *prev) {
+            return true;
+        }
+
+        if (cadence == Cadence::BeforeLoopEnd && isLooping(info)) {
+            auto trigger = info.loop_end_in_ppq - beatLength(info);
+            return *prev < trigger && ppq >= trigger;
+        }
+
+        auto o = origin(info);
+        auto p = period(info);
+        return boundaryIndex(ppq, o, p) != boundaryIndex(*prev, o, p);
+    }
+
+    double nextTarget(const BufferMetaData &info) const {
+        if (cadence == Cadence::BeforeLoopEnd && isLooping(info)) {
+            return info.loop_end_in_ppq;
+        }
+
+        auto o = origin(info);
+        auto p = period(info);
+        return o + (boundaryIndex(info.time_in_ppq, o, p) + 1) * p;
+    }
+
+    // held results wait for the next bar line, or the loop end if it comes first
+    double nextHoldRelease(const BufferMetaData &info) const {
+        auto o = info.ppq_position_of_last_bar_start >= 0 ? info.ppq_position_of_last_bar_start : 0.0;
+        auto p = barLength(info);
+        auto next_bar = o + (boundaryIndex(info.time_in_ppq, o, p) + 1) * p;
+        if (isLooping(info) && info.time_in_ppq < info.loop_end_in_ppq) {
+            return std::min(next_bar, info.loop_end_in_ppq);
+        }
+        return next_bar;
+    }
+};
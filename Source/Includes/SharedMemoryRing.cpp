@@ -0,0 +1,189 @@
+#include "SharedMemoryRing.h"
+
+#include <chrono>
+#include <thread>
+
+#if defined(_WIN32) || defined(_WIN64)
+#   define WIN32_LEAN_AND_MEAN
+#   define NOMINMAX
+#   include <Windows.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#   include <climits>
+#   include <linux/futex.h>
+#   include <sys/syscall.h>
+#endif
+
+// ============================================================================================================
+// ==========          SharedMemorySegment                            =========================================
+// ============================================================================================================
+#if defined(_WIN32) || defined(_WIN64)
+
+bool SharedMemorySegment::create(const std::string& name, size_t size) {
+    close();
+    auto mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                      (DWORD) ((uint64_t) size >> 32), (DWORD) (size & 0xFFFFFFFF),
+                                      ("Local\\" + name).c_str());
+    if (mapping == nullptr) {
+        return false;
+    }
+    data = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (data == nullptr) {
+        CloseHandle(mapping);
+        return false;
+    }
+    std::memset(data, 0, size);
+    handle = mapping;
+    name_ = name;
+    size_ = size;
+    owner = true;
+    return true;
+}
+
+bool SharedMemorySegment::open(const std::string& name, size_t size) {
+    close();
+    auto mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, ("Local\\" + name).c_str());
+    if (mapping == nullptr) {
+        return false;
+    }
+    data = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (data == nullptr) {
+        CloseHandle(mapping);
+        return false;
+    }
+    handle = mapping;
+    name_ = name;
+    size_ = size;
+    owner = false;
+    return true;
+}
+
+void SharedMemorySegment::close() {
+    if (data != nullptr) { UnmapViewOfFile(data); }
+    if (handle != nullptr) { CloseHandle((HANDLE) handle); }
+    data = nullptr;
+    handle = nullptr;
+    size_ = 0;
+}
+
+#else
+
+bool SharedMemorySegment::create(const std::string& name, size_t size) {
+    close();
+    auto posix_name = "/" + name;
+    shm_unlink(posix_name.c_str());     // left over by a crashed instance
+    auto fd = shm_open(posix_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        return false;
+    }
+    if (ftruncate(fd, (off_t) size) != 0) {
+        ::close(fd);
+        shm_unlink(posix_name.c_str());
+        return false;
+    }
+    auto mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        shm_unlink(posix_name.c_str());
+        return false;
+    }
+    std::memset(mapped, 0, size);
+    data = mapped;
+    name_ = name;
+    size_ = size;
+    owner = true;
+    return true;
+}
+
+bool SharedMemorySegment::open(const std::string& name, size_t size) {
+    close();
+    auto fd = shm_open(("/" + name).c_str(), O_RDWR, 0600);
+    if (fd < 0) {
+        return false;
+    }
+    auto mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    data = mapped;
+    name_ = name;
+    size_ = size;
+    owner = false;
+    return true;
+}
+
+void SharedMemorySegment::close() {
+    if (data != nullptr) {
+        munmap(data, size_);
+        if (owner) { shm_unlink(("/" + name_).c_str()); }
+    }
+    data = nullptr;
+    size_ = 0;
+    owner = false;
+}
+
+#endif
+
+
+// ============================================================================================================
+// ==========          Doorbell                                       =========================================
+// ============================================================================================================
+namespace doorbell {
+
+#if defined(__linux__)
+
+    // std::atomic<uint32_t> has the same layout as uint32_t (checked below), so the counter is used as futex word
+    // (not FUTEX_PRIVATE, the word is shared between processes)
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t));
+
+    bool wait(std::atomic<uint32_t>* counter, uint32_t seen, int timeout_ms) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+        while (counter->load(std::memory_order_acquire) == seen) {
+            auto remaining = deadline - std::chrono::steady_clock::now();
+            if (remaining <= std::chrono::nanoseconds(0)) {
+                return false;
+            }
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count();
+            timespec timeout{(time_t) (ns / 1000000000), (long) (ns % 1000000000)};
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(counter), FUTEX_WAIT, seen, &timeout, nullptr, 0);
+        }
+        return true;
+    }
+
+    void ring(std::atomic<uint32_t>* counter) {
+        counter->fetch_add(1, std::memory_order_release);
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(counter), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    }
+
+#else
+
+    bool wait(std::atomic<uint32_t>* counter, uint32_t seen, int timeout_ms) {
+        // most requests are answered within a few hundred microseconds, so spin briefly before sleeping
+        for (int i = 0; i < 2000; i++) {
+            if (counter->load(std::memory_order_acquire) != seen) { return true; }
+            std::this_thread::yield();
+        }
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+        while (counter->load(std::memory_order_acquire) == seen) {
+            if (std::chrono::steady_clock::now() >= deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        return true;
+    }
+
+    void ring(std::atomic<uint32_t>* counter) {
+        counter->fetch_add(1, std::memory_order_release);
+    }
+
+#endif
+
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+// ============================================================================================================
+// ==========          SharedMemorySegment                            =========================================
+// ============================================================================================================
+/*
+ * Named shared memory region that can be mapped by several processes (implemented in SharedMemoryRing.cpp)
+ *      POSIX   : shm_open + mmap (the creator unlinks the name when destroyed)
+ *      Windows : page file backed CreateFileMapping
+ *
+ * Names should be short (macOS limits them to 31 characters) and unique per instance (i.e. include the pid).
+ */
+class SharedMemorySegment {
+public:
+    SharedMemorySegment() = default;
+    ~SharedMemorySegment() { close(); }
+
+    SharedMemorySegment(const SharedMemorySegment&) = delete;
+    SharedMemorySegment& operator=(const SharedMemorySegment&) = delete;
+
+    // creates (and zero initializes) a new segment, returns false if not possible
+    bool create(const std::string& name, size_t size);
+
+    // maps an existing segment created by another process
+    bool open(const std::string& name, size_t size);
+
+    void close();
+
+    [[nodiscard]] void* getData() const { return data; }
+    [[nodiscard]] size_t getSize() const { return size_; }
+    [[nodiscard]] bool isOpen() const { return data != nullptr; }
+
+private:
+    std::string name_;
+    void* data{nullptr};
+    size_t size_{0};
+    bool owner{false};
+    void* handle{nullptr};      // Windows only
+};
+
+
+// ============================================================================================================
+// ==========          Doorbell                                       =========================================
+// ============================================================================================================
+/*
+ * Wakes up a reader waiting in another process. The counter is incremented on each ring() and the reader waits
+ * until it differs from the last value it has seen, so wake ups can't be lost.
+ *      Linux  : futex on the counter (the reader sleeps in the kernel, no polling)
+ *      others : short spin, then polling with small sleeps
+ */
+namespace doorbell {
+    // blocks until *counter != seen or until timeout_ms elapsed, returns false on timeout
+    bool wait(std::atomic<uint32_t>* counter, uint32_t seen, int timeout_ms);
+
+    void ring(std::atomic<uint32_t>* counter);
+}
+
+
+// ============================================================================================================
+// ==========          SharedMemoryRing                               =========================================
+// ============================================================================================================
+/*
+ * Lock-free single producer/single consumer ring of variable size messages, placed in shared memory.
+ * Messages are stored as [uint32 size][bytes] and may wrap around the end of the buffer.
+ *
+ * The ring doesn't own its memory: use bytesRequired(capacity) to size the region, initialize() it once
+ * (in the process creating the segment) and attach() to it in both processes.
+ */
+class SharedMemoryRing {
+public:
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "atomics in shared memory must be lock free");
+    static_assert(std::atomic<uint32_t>::is_always_lock_free, "atomics in shared memory must be lock free");
+
+    static size_t bytesRequired(uint32_t capacity) { return sizeof(Header) + capacity; }
+
+    static void initialize(void* memory, uint32_t capacity) {
+        auto header = new (memory) Header();
+        header->capacity = capacity;
+    }
+
+    void attach(void* memory) {
+        header = static_cast<Header*>(memory);
+        buffer = static_cast<uint8_t*>(memory) + sizeof(Header);
+    }
+
+    // producer side: returns false if the message doesn't fit in the free space
+    bool write(const void* message, uint32_t size) {
+        auto write_pos = header->write_pos.load(std::memory_order_relaxed);
+        auto read_pos = header->read_pos.load(std::memory_order_acquire);
+        if (header->capacity - (write_pos - read_pos) < sizeof(uint32_t) + (uint64_t) size) {
+            return false;
+        }
+
+        copyIn(write_pos, &size, sizeof(uint32_t));
+        copyIn(write_pos + sizeof(uint32_t), message, size);
+        header->write_pos.store(write_pos + sizeof(uint32_t) + size, std::memory_order_release);
+        doorbell::ring(&header->doorbell);
+        return true;
+    }
+
+    // consumer side: returns false if no message is available
+    bool read(std::vector<uint8_t>& message) {
+        auto read_pos = header->read_pos.load(std::memory_order_relaxed);
+        auto write_pos = header->write_pos.load(std::memory_order_acquire);
+        if (write_pos - read_pos < sizeof(uint32_t)) {
+            return false;
+        }
+
+        uint32_t size = 0;
+        copyOut(read_pos, &size, sizeof(uint32_t));
+        message.resize(size);
+        copyOut(read_pos + sizeof(uint32_t), message.data(), size);
+        header->read_pos.store(read_pos + sizeof(uint32_t) + size, std::memory_order_release);
+        return true;
+    }
+
+    [[nodiscard]] bool hasData() const {
+        return header->write_pos.load(std::memory_order_acquire) != header->read_pos.load(std::memory_order_relaxed);
+    }
+
+    // consumer side: waits until a message is available, returns false on timeout
+    bool waitForData(int timeout_ms) {
+        auto seen = header->doorbell.load(std::memory_order_acquire);
+        if (hasData()) {
+            return true;
+        }
+        doorbell::wait(&header->doorbell, seen, timeout_ms);
+        return hasData();
+    }
+
+    // drops all messages not read yet (consumer side)
+    void discardAll() {
+        header->read_pos.store(header->write_pos.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+private:
+    struct Header {
+        alignas(64) std::atomic<uint64_t> write_pos{0};
+        alignas(64) std::atomic<uint64_t> read_pos{0};
+        alignas(64) std::atomic<uint32_t> doorbell{0};
+        uint32_t capacity{0};
+    };
+
+    Header* header{nullptr};
+    uint8_t* buffer{nullptr};
+
+    void copyIn(uint64_t pos, const void* src, size_t size) {
+        auto offset = (size_t) (pos % header->capacity);
+        auto first = std::min(size, (size_t) header->capacity - offset);
+        std::memcpy(buffer + offset, src, first);
+        std::memcpy(buffer, static_cast<const uint8_t*>(src) + first, size - first);
+    }
+
+    void copyOut(uint64_t pos, void* dst, size_t size) const {
+        auto offset = (size_t) (pos % header->capacity);
+        auto first = std::min(size, (size_t) header->capacity - offset);
+        std::memcpy(dst, buffer + offset, first);
+        std::memcpy(static_cast<uint8_t*>(dst) + first, buffer, size - first);
+    }
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "shared_plugin_helpers/shared_plugin_helpers.h"
+#include <deque>
+#include <functional>
+#include <mutex>
+
+// ============================================================================================================
+// ==========          SpeculativeJobThread                          ==========================================
+// ============================================================================================================
+/*
+ * Low priority helper thread used by the DeploymentThread to precompute results that MAY be needed soon
+ * (for instance, generations for neighbouring parameter values).
+ *
+ * Jobs are submitted as a batch. Submitting a new batch discards all jobs of the previous batch that have not
+ * started yet (latest wins), so the thread never works on outdated requests for long.
+ *
+ * Jobs run on this thread, so they must only touch data that is either copied into the job or
+ * protected (e.g. LRUCache).
+ */
+class SpeculativeJobThread : public juce::Thread {
+public:
+    using Job = std::function<void()>;
+
+    SpeculativeJobThread() : juce::Thread("SpeculativeJobThread") {}
+
+    ~SpeculativeJobThread() override {
+        prepareToStop();
+    }
+
+    // replaces any pending jobs with the new batch
+    void submit(std::vector<Job> jobs) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pendingJobs.clear();
+            for (auto& job : jobs) {
+                pendingJobs.push_back(std::move(job));
+            }
+        }
+
+        if (!isThreadRunning()) {
+            startThread(juce::Thread::Priority::low);
+        }
+        notify();
+    }
+
+    // drops all jobs that have not started yet
+    void cancelPendingJobs() {
+        std::lock_guard<std::mutex> lock(mutex);
+        pendingJobs.clear();
+    }
+
+    [[nodiscard]] size_t getNumPendingJobs() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return pendingJobs.size();
+    }
+
+    void run() override {
+        while (!threadShouldExit()) {
+            Job job;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!pendingJobs.empty()) {
+                    job = std::move(pendingJobs.front());
+                    pendingJobs.pop_front();
+                }
+            }
+
+            if (job) {
+                job();
+            } else {
+                // sleep until a new batch is submitted
+                wait(-1);
+            }
+        }
+    }
+
+    // waits for the running job (if any) to finish, a thread killed mid inference could leave libtorch's
+    // state corrupted
+    void prepareToStop() {
+        cancelPendingJobs();
+        signalThreadShouldExit();
+        notify();
+        stopThread(-1);
+    }
+
+private:
+    std::deque<Job> pendingJobs;
+    mutable std::mutex mutex;
+};
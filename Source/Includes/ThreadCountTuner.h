@@ -0,0 +1,112 @@
+#pragma once
+
+#include "shared_plugin_helpers/shared_plugin_helpers.h"
+#include "Configs_Parser.h"
+#include "TorchScriptAndPresetLoaders.h"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <optional>
+
+// ============================================================================================================
+// ==========          ThreadCountTuner                               =========================================
+// ============================================================================================================
+/*
+ * Finds the fastest intra-op thread count for a model on the current machine.
+ *
+ * tune() times a user provided inference call (i.e. encode + sample) for 1..max_threads threads and returns
+ * the fastest count. More threads are only chosen if they are noticeably faster (min_speedup), since small
+ * models often get slower due to synchronization overhead.
+ *
+ * The choice is persisted in `thread_tuning.json` in the preset directory. Entries are keyed by a fingerprint
+ * of the model file (path, size, modification time) and the cpu (model, number of cores), so tuning only
+ * runs again if either changes.
+ */
+class ThreadCountTuner {
+public:
+    using RunFn = std::function<void()>;
+    using SetThreadsFn = std::function<void(int)>;
+
+    static std::string makeFingerprint(const std::string& model_path) {
+        juce::File model_file(model_path);
+        std::stringstream ss;
+        ss << model_path
+           << "|" << model_file.getSize()
+           << "|" << model_file.getLastModificationTime().toMilliseconds()
+           << "|" << juce::SystemStats::getCpuModel().toStdString()
+           << "|" << juce::SystemStats::getNumCpus();
+        return ss.str();
+    }
+
+    // returns the persisted choice for the fingerprint if available (an invalid entry is a cache miss)
+    static std::optional<int> loadCachedChoice(const std::string& fingerprint) {
+        auto cache = readCacheFile();
+        if (cache.contains(fingerprint) && cache[fingerprint].is_object() &&
+            cache[fingerprint].contains("num_threads") && cache[fingerprint]["num_threads"].is_number_integer()) {
+            auto num_threads = cache[fingerprint]["num_threads"].get<int>();
+            if (num_threads > 0) {
+                return num_threads;
+            }
+        }
+        return std::nullopt;
+    }
+
+    // times run_once for each thread count and returns the fastest one (also persisted for the fingerprint)
+    // the caller is responsible for applying the returned count
+    static int tune(const std::string& fingerprint, const RunFn& run_once, const SetThreadsFn& set_threads,
+                    int max_threads = 8, int num_runs = 10, double min_speedup = 1.05) {
+        max_threads = std::max(1, std::min(max_threads, juce::SystemStats::getNumCpus()));
+
+        std::vector<double> timings_ms;
+        int best_threads = 1;
+        double best_ms = 0;
+
+        for (int num_threads = 1; num_threads <= max_threads; num_threads++) {
+            set_threads(num_threads);
+            run_once();     // warm up (thread pool creation, allocations)
+
+            // median of num_runs calls
+            std::vector<double> runs;
+            for (int i = 0; i < num_runs; i++) {
+                auto start = std::chrono::steady_clock::now();
+                run_once();
+                auto end = std::chrono::steady_clock::now();
+                runs.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+            }
+            std::nth_element(runs.begin(), runs.begin() + (long) runs.size() / 2, runs.end());
+            auto median_ms = runs[runs.size() / 2];
+            timings_ms.push_back(median_ms);
+
+            if (num_threads == 1 || median_ms * min_speedup < best_ms) {
+                best_threads = num_threads;
+                best_ms = median_ms;
+            }
+        }
+
+        auto cache = readCacheFile();
+        cache[fingerprint] = {{"num_threads", best_threads}, {"timings_ms", timings_ms}};
+        writeCacheFile(cache);
+
+        return best_threads;
+    }
+
+private:
+    static juce::File getCacheFile() {
+        return juce::File(stripQuotes(default_preset_dir) + path_separator + "thread_tuning.json");
+    }
+
+    static json readCacheFile() {
+        auto file = getCacheFile();
+        if (!file.existsAsFile()) {
+            return json::object();
+        }
+        auto parsed = json::parse(file.loadFileAsString().toStdString(), nullptr, false);
+        return parsed.is_object() ? parsed : json::object();
+    }
+
+    static void writeCacheFile(const json& cache) {
+        auto file = getCacheFile();
+        file.getParentDirectory().createDirectory();
+        file.replaceWithText(cache.dump(4));
+    }
+};
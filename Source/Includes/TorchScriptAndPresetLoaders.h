@@ -4,6 +4,22 @@
 
 # pragma once
 
+#include "shared_plugin_helpers/shared_plugin_helpers.h"
+#include "Configs_Parser.h"
+#include <torch/script.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+
 
 #define STRINGIFY(x) #x
 #define TOSTRING(x) STRINGIFY(x)
@@ -44,46 +60,338 @@ inline torch::jit::Module load_processing_script(const std::string& script_name)
     return torch::jit::load(script_path);
 }
 
-inline void save_tensor_map(const std::map<std::string, torch::Tensor>& m, const std::string& file_name) {
-    std::string fp = stripQuotes(default_preset_dir) + path_separator + file_name;
-    std::ofstream out_file(fp, std::ios::out | std::ios::binary);
-
-    for (const auto& pair : m) {
-        const std::string& key = pair.first;
-        const torch::Tensor& t = pair.second;
-
-        // Write the key
-        auto key_size = (long long) key.size();
-        out_file.write(reinterpret_cast<const char*>(&key_size), sizeof(key_size));
-        out_file.write(key.c_str(), key_size);
-
-        // Write tensor metadata
-        const at::IntArrayRef& sizes = t.sizes();
-        auto nb_dims = (int64_t) sizes.size();
-        out_file.write(reinterpret_cast<const char*>(&nb_dims), sizeof(nb_dims));
-        for (int64_t size : sizes) {
-            out_file.write(reinterpret_cast<const char*>(&size), sizeof(int64_t));
+// ============================================================================================================
+// ==========          Preset Tensor Files (.preset_data)             =========================================
+// ============================================================================================================
+/*
+ * Container format (version 2, native byte order):
+ *
+ *      header  (64 bytes) : magic "NMFXPRST" | uint32 version | uint32 num_entries |
+ *                           uint64 index_size | uint32 index_crc | zero padding
+ *      index   (starts at byte 64) : for each entry
+ *                           uint32 key_size | key | int32 dtype | int32 ndim | int64 sizes[ndim] |
+ *                           uint32 encoding (version 2 only) | uint64 offset | uint64 nbytes | uint32 crc
+ *      payloads            : contiguous tensor data, each starting at a 64 byte aligned offset
+ *                            (nbytes and crc refer to the stored, possibly encoded, bytes)
+ *
+ * Encoding flags (see EncodingOptions, chosen per tensor when saving):
+ *      encoding_fp16 : float32/float64 data stored as fp16 (lossy), converted back to dtype when loaded
+ *      encoding_gzip : data compressed with juce's zlib streams, only used if it makes the entry smaller
+ *
+ * Unencoded tensors are loaded as views into a memory mapping of the file (no copies). They are read-only:
+ * clone() them before modifying them in place. On Windows, mapped files can't be replaced, so the file is read
+ * into a single shared buffer instead (one copy). Encoded tensors are decoded into their own memory.
+ *
+ * Files without the magic are read with the legacy (headerless) reader, and are converted to the new format
+ * the next time the preset is saved.
+ */
+namespace preset_tensor_file {
+    constexpr char magic[8] = {'N', 'M', 'F', 'X', 'P', 'R', 'S', 'T'};
+    constexpr uint32_t version = 2;
+    constexpr uint32_t encoding_gzip = 1;
+    constexpr uint32_t encoding_fp16 = 2;
+
+    struct EncodingOptions {
+        int64_t compression_threshold_bytes{-1};    // tensors of at least this size are compressed (-1: never)
+        bool store_as_fp16{false};                  // float32/float64 tensors are stored as fp16
+        int compression_level{6};                   // zlib level (1: fastest ... 9: smallest)
+    };
+
+    // options from the preset_settings section of settings.json
+    inline EncodingOptions defaultEncodingOptions() {
+        EncodingOptions options;
+        options.compression_threshold_bytes = preset_settings::compression_threshold_kb < 0 ?
+            -1 : (int64_t) preset_settings::compression_threshold_kb * 1024;
+        options.store_as_fp16 = preset_settings::store_as_fp16;
+        options.compression_level = preset_settings::compression_level;
+        return options;
+    }
+    constexpr size_t header_size = 64;
+    constexpr size_t alignment = 64;
+
+    inline size_t align(size_t offset) { return (offset + alignment - 1) & ~(alignment - 1); }
+
+    // crc32 (same polynomial as zlib)
+    inline uint32_t crc32(const void* data, size_t size, uint32_t crc = 0) {
+        static const auto table = [] {
+            std::array<uint32_t, 256> t{};
+            for (uint32_t i = 0; i < 256; i++) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; k++) { c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1; }
+                t[i] = c;
+            }
+            return t;
+        }();
+
+        crc = ~crc;
+        auto bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; i++) {
+            crc = table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
         }
+        return ~crc;
+    }
 
-        auto scalar_type = static_cast<int64_t>(t.scalar_type());
-        out_file.write(reinterpret_cast<const char*>(&scalar_type), sizeof(scalar_type));
+    template <typename T>
+    void append(std::vector<uint8_t>& out, T value) {
+        auto bytes = reinterpret_cast<const uint8_t*>(&value);
+        out.insert(out.end(), bytes, bytes + sizeof(T));
+    }
+
+    template <typename T>
+    bool read(const uint8_t* data, size_t size, size_t& pos, T& value) {
+        if (pos + sizeof(T) > size) {
+            return false;
+        }
+        std::memcpy(&value, data + pos, sizeof(T));
+        pos += sizeof(T);
+        return true;
+    }
 
-        int64_t elem_size = t.element_size();
-        out_file.write(reinterpret_cast<const char*>(&elem_size), sizeof(elem_size));
+    inline bool hasMagic(const void* data, size_t size) {
+        return size >= header_size && std::memcmp(data, magic, sizeof(magic)) == 0;
+    }
 
-        int64_t num_el = t.numel();
-        out_file.write(reinterpret_cast<const char*>(&num_el), sizeof(num_el));
+    // stored form of a tensor
+    struct EncodedTensor {
+        torch::Tensor tensor;           // contiguous (fp16 if encoding_fp16)
+        juce::MemoryBlock compressed;   // only if encoding_gzip
+        uint32_t encoding{0};
 
-        // Write tensor data
-        out_file.write(reinterpret_cast<const char*>(t.data_ptr()), elem_size * num_el);
+        [[nodiscard]] const void* data() const {
+            return (encoding & encoding_gzip) ? compressed.getData() : tensor.data_ptr();
+        }
+        [[nodiscard]] size_t nbytes() const {
+            return (encoding & encoding_gzip) ? compressed.getSize() : tensor.nbytes();
+        }
+    };
+
+    inline EncodedTensor encode(const torch::Tensor& t, const EncodingOptions& options) {
+        EncodedTensor encoded;
+        encoded.tensor = t.contiguous().cpu();
+        if (options.store_as_fp16 &&
+            (encoded.tensor.scalar_type() == torch::kFloat || encoded.tensor.scalar_type() == torch::kDouble)) {
+            encoded.tensor = encoded.tensor.to(torch::kHalf);
+            encoded.encoding |= encoding_fp16;
+        }
 
+        auto nbytes = encoded.tensor.nbytes();
+        if (options.compression_threshold_bytes >= 0 && (int64_t) nbytes >= options.compression_threshold_bytes) {
+            juce::MemoryOutputStream compressed_stream(encoded.compressed, false);
+            {
+                juce::GZIPCompressorOutputStream gzip(compressed_stream, options.compression_level);
+                gzip.write(encoded.tensor.data_ptr(), nbytes);
+            }   // flushed when destroyed
+            if (encoded.compressed.getSize() < nbytes) {
+                encoded.encoding |= encoding_gzip;
+            } else {
+                encoded.compressed.reset();     // incompressible (i.e. noise), stored as is
+            }
+        }
+        return encoded;
     }
 
-    out_file.close();
+    // writes the tensors to the stream in the container format
+    inline bool write(const std::map<std::string, torch::Tensor>& m, juce::OutputStream& out,
+                      const EncodingOptions& options = {}) {
+        std::vector<EncodedTensor> tensors;
+        for (const auto& [key, t] : m) {
+            tensors.push_back(encode(t, options));
+        }
+
+        // the index size is needed to place the payloads, so it is built with placeholder offsets first
+        auto buildIndex = [&](const std::vector<uint64_t>& offsets) {
+            std::vector<uint8_t> index;
+            size_t i = 0;
+            for (const auto& [key, t] : m) {
+                const auto& encoded = tensors[i];
+                append(index, (uint32_t) key.size());
+                index.insert(index.end(), key.begin(), key.end());
+                append(index, (int32_t) t.scalar_type());     // original type
+                append(index, (int32_t) encoded.tensor.dim());
+                for (auto size : encoded.tensor.sizes()) { append(index, (int64_t) size); }
+                append(index, encoded.encoding);
+                append(index, offsets.empty() ? (uint64_t) 0 : offsets[i]);
+                append(index, (uint64_t) encoded.nbytes());
+                append(index, crc32(encoded.data(), encoded.nbytes()));
+                i++;
+            }
+            return index;
+        };
+
+        std::vector<uint64_t> offsets;
+        auto offset = align(header_size + buildIndex({}).size());
+        for (const auto& encoded : tensors) {
+            offsets.push_back(offset);
+            offset = align(offset + encoded.nbytes());
+        }
+        auto index = buildIndex(offsets);
+
+        std::vector<uint8_t> header;
+        header.insert(header.end(), magic, magic + sizeof(magic));
+        append(header, version);
+        append(header, (uint32_t) tensors.size());
+        append(header, (uint64_t) index.size());
+        append(header, crc32(index.data(), index.size()));
+        header.resize(header_size, 0);
+
+        bool ok = out.write(header.data(), header.size()) && out.write(index.data(), index.size());
+        auto position = header_size + index.size();
+        for (size_t i = 0; i < tensors.size() && ok; i++) {
+            ok = out.writeRepeatedByte(0, offsets[i] - position);
+            ok = ok && out.write(tensors[i].data(), tensors[i].nbytes());
+            position = offsets[i] + tensors[i].nbytes();
+        }
+        return ok;
+    }
+
+    // parses the container held in memory, tensors keep `owner` alive (i.e. the mapping of the file)
+    // returns nullopt if the data is truncated/corrupted (the whole file is rejected)
+    inline std::optional<std::map<std::string, torch::Tensor>> parse(
+        const uint8_t* data, size_t size, const std::shared_ptr<void>& owner, bool verify_checksums = true) {
+
+        if (!hasMagic(data, size)) {
+            return std::nullopt;
+        }
+
+        size_t pos = sizeof(magic);
+        uint32_t file_version = 0, num_entries = 0, index_crc = 0;
+        uint64_t index_size = 0;
+        if (!read(data, size, pos, file_version) || !read(data, size, pos, num_entries) ||
+            !read(data, size, pos, index_size) || !read(data, size, pos, index_crc) ||
+            file_version > version || header_size + index_size > size ||
+            crc32(data + header_size, index_size) != index_crc) {
+            return std::nullopt;
+        }
+
+        std::map<std::string, torch::Tensor> m;
+        pos = header_size;
+        auto index_end = header_size + index_size;
+        for (uint32_t i = 0; i < num_entries; i++) {
+            uint32_t key_size = 0;
+            if (!read(data, index_end, pos, key_size) || pos + key_size > index_end) {
+                return std::nullopt;
+            }
+            std::string key(reinterpret_cast<const char*>(data + pos), key_size);
+            pos += key_size;
+
+            int32_t dtype = 0, ndim = 0;
+            if (!read(data, index_end, pos, dtype) || !read(data, index_end, pos, ndim) || ndim < 0) {
+                return std::nullopt;
+            }
+            std::vector<int64_t> sizes((size_t) ndim);
+            for (auto& dim : sizes) {
+                if (!read(data, index_end, pos, dim)) { return std::nullopt; }
+            }
+
+            uint32_t encoding = 0;
+            if (file_version >= 2 && !read(data, index_end, pos, encoding)) {
+                return std::nullopt;
+            }
+
+            uint64_t offset = 0, nbytes = 0;
+            uint32_t crc = 0;
+            if (!read(data, index_end, pos, offset) || !read(data, index_end, pos, nbytes) ||
+                !read(data, index_end, pos, crc) || offset + nbytes > size) {
+                return std::nullopt;
+            }
+
+            auto options = torch::TensorOptions().dtype((c10::ScalarType) dtype);
+            auto stored_options = (encoding & encoding_fp16) ? options.dtype(torch::kHalf) : options;
+            auto stored_nbytes = (uint64_t) c10::multiply_integers(sizes) * stored_options.dtype().itemsize();
+            if (!(encoding & encoding_gzip) && stored_nbytes != nbytes) {
+                return std::nullopt;
+            }
+            if (verify_checksums && crc32(data + offset, nbytes) != crc) {
+                std::cout << "Preset tensor " << key << " failed its checksum" << std::endl;
+                return std::nullopt;
+            }
+
+            torch::Tensor tensor;
+            if (encoding & encoding_gzip) {
+                juce::MemoryInputStream compressed(data + offset, nbytes, false);
+                juce::GZIPDecompressorInputStream gzip(compressed);
+                tensor = torch::empty(sizes, stored_options);
+                if ((uint64_t) gzip.read(tensor.data_ptr(), (int) stored_nbytes) != stored_nbytes) {
+                    std::cout << "Preset tensor " << key << " failed to decompress" << std::endl;
+                    return std::nullopt;
+                }
+            } else {
+                // the deleter keeps the owner alive as long as the tensor (or any view of it) exists
+                tensor = torch::from_blob(const_cast<uint8_t*>(data + offset), sizes,
+                                          [owner](void*) {}, stored_options);
+            }
+            m[key] = (encoding & encoding_fp16) ? tensor.to(options.dtype()) : tensor;
+        }
+        return m;
+    }
+
+    // compares the size and the save/load times of the tensors with the different encodings (in memory, so
+    // only the encoding cost is measured, the loader maps the file and parses it the same way)
+    inline std::string benchmark(const std::map<std::string, torch::Tensor>& m, int num_runs = 5) {
+        struct Candidate { std::string name; EncodingOptions options; };
+        std::vector<Candidate> candidates{{"raw", {}}, {"fp16", {-1, true}}, {"gzip", {0, false}},
+                                          {"gzip + fp16", {0, true}}, {"settings.json", defaultEncodingOptions()}};
+
+        auto median_ms = [](std::vector<double> times) {
+            std::nth_element(times.begin(), times.begin() + (long) times.size() / 2, times.end());
+            return times[times.size() / 2];
+        };
+
+        std::stringstream ss;
+        ss << "Preset data encodings (" << m.size() << " tensors, median of " << num_runs << " runs):" << std::endl;
+        for (const auto& candidate : candidates) {
+            std::vector<double> save_times, load_times;
+            size_t file_size = 0;
+            for (int run = 0; run < num_runs; run++) {
+                auto block = std::make_shared<juce::MemoryBlock>();
+                auto start = std::chrono::steady_clock::now();
+                {
+                    juce::MemoryOutputStream out(*block, false);
+                    write(m, out, candidate.options);
+                }
+                auto saved = std::chrono::steady_clock::now();
+                auto loaded = parse(static_cast<const uint8_t*>(block->getData()), block->getSize(), block);
+                auto end = std::chrono::steady_clock::now();
+
+                file_size = block->getSize();
+                save_times.push_back(std::chrono::duration<double, std::milli>(saved - start).count());
+                load_times.push_back(std::chrono::duration<double, std::milli>(end - saved).count());
+                if (!loaded.has_value()) {
+                    break;
+                }
+            }
+            if (load_times.size() < (size_t) num_runs) {
+                ss << candidate.name << " | failed to load" << std::endl;
+                continue;
+            }
+            ss << candidate.name << " | size: " << file_size / 1024.0 << " KB"
+               << " | save: " << median_ms(save_times) << " ms"
+               << " | load: " << median_ms(load_times) << " ms" << std::endl;
+        }
+        return ss.str();
+    }
 }
 
+// writes the tensors to <preset dir>/<file_name> (via a temporary file, so that the previous file, which may be
+// mapped by tensors still in use, is only replaced once the new one is complete)
+inline bool save_tensor_map(const std::map<std::string, torch::Tensor>& m, const std::string& file_name) {
+    juce::File file(stripQuotes(default_preset_dir) + path_separator + file_name);
+    juce::TemporaryFile temp(file);
+    bool ok = false;
+    if (auto out = temp.getFile().createOutputStream()) {
+        ok = preset_tensor_file::write(m, *out, preset_tensor_file::defaultEncodingOptions());
+        out->flush();
+        ok = ok && out->getStatus().wasOk();
+    }
+    if (!ok || !temp.overwriteTargetFileWithTemporary()) {
+        std::cout << "Failed to save preset data to: " << file.getFullPathName() << std::endl;
+        return false;
+    }
+    return true;
+}
 
-inline std::map<std::string, torch::Tensor> load_tensor_map(const std::string& file_name) {
+// reader for the headerless files written before the .preset_data container existed (kept for migration)
+inline std::map<std::string, torch::Tensor> load_tensor_map_legacy(const std::string& file_name) {
     std::string fp = stripQuotes(default_preset_dir) + path_separator + file_name;
     std::ifstream in_file(fp, std::ios::in | std::ios::binary);
     std::map<std::string, torch::Tensor> m;
@@ -125,40 +433,118 @@ inline std::map<std::string, torch::Tensor> load_tensor_map(const std::string& f
     return m;
 }
 
-#include <mutex>
+// loads <preset dir>/<file_name> (see preset_tensor_file above), falls back to the legacy reader for old files
+// a corrupted/truncated file results in an empty map
+inline std::map<std::string, torch::Tensor> load_tensor_map(const std::string& file_name) {
+    juce::File file(stripQuotes(default_preset_dir) + path_separator + file_name);
+    if (!file.existsAsFile()) {
+        return {};
+    }
 
+#if JUCE_WINDOWS
+    auto block = std::make_shared<juce::MemoryBlock>();
+    if (!file.loadFileAsData(*block)) {
+        return {};
+    }
+    auto data = static_cast<const uint8_t*>(block->getData());
+    auto size = block->getSize();
+    std::shared_ptr<void> owner = block;
+#else
+    auto mapping = std::make_shared<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+    if (mapping->getData() == nullptr) {
+        return {};
+    }
+    auto data = static_cast<const uint8_t*>(mapping->getData());
+    auto size = mapping->getSize();
+    std::shared_ptr<void> owner = mapping;
+#endif
+
+    if (!preset_tensor_file::hasMagic(data, size)) {
+        return load_tensor_map_legacy(file_name);
+    }
+
+    if (auto m = preset_tensor_file::parse(data, size, owner)) {
+        return *m;
+    }
+    std::cout << "Preset data is corrupted or truncated: " << file.getFullPathName() << std::endl;
+    return {};
+}
+
+/*
+ * Tensors shared between the DeploymentThread, the preset loading and the GUI (saved with the presets).
+ *
+ * The content is an immutable snapshot: writers copy the current map, modify the copy and publish it
+ * (atomic_store of a shared_ptr<const Snapshot>), readers take the current snapshot with a single atomic_load
+ * and read it without any locks. Tensors are handles, so copying the map doesn't copy tensor data.
+ *
+ * Each publish increments a global version, and each entry records the version at which it was last written.
+ * Changes coming from outside the DeploymentThread (i.e. a loaded preset, copy_from_map()) are reported by
+ * hasTensorDataChanged() until the changed entries are read with tensor(label) (or all at once with tensors()).
+ * Writes with tensor(label, tensor) are considered already seen.
+ */
 class CustomPresetDataDictionary
 {
+public:
+    struct Snapshot {
+        std::map<std::string, torch::Tensor> tensors;
+        std::map<std::string, uint64_t> versions;       // version at which each entry was last written
+        uint64_t version{0};
+    };
+
 private:
-    std::map<std::string, torch::Tensor> tensorMap;
-    std::map<std::string, bool> changeFlags;  // Track changes for each key
-    mutable std::mutex mutex;
-    bool changed = false;
+    std::shared_ptr<const Snapshot> current{std::make_shared<const Snapshot>()};
+    std::atomic<uint64_t> version{0};
+    std::atomic<uint64_t> consumed_version{0};              // all changes up to this version have been read
+    std::atomic<int> updates_in_progress{0};                // changes aren't reported while > 0
+    std::mutex write_mutex;                                 // serializes writers (readers never lock it)
+    std::mutex seen_mutex;                                  // guards seen_versions (only taken by reads by label)
+    std::map<std::string, uint64_t> seen_versions;
+
+    // replaces the content, if local is true the change is not reported by hasTensorDataChanged()
+    void publish(const std::function<void(Snapshot&)>& modify, bool local) {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        auto next = std::make_shared<Snapshot>(*snapshot());
+        next->version = version.load() + 1;
+        modify(*next);
+        std::atomic_store(&current, std::shared_ptr<const Snapshot>(std::move(next)));
+
+        auto previous_version = version.fetch_add(1);
+        if (local) {
+            // nothing new for readers if they were up to date before this write
+            auto expected = previous_version;
+            consumed_version.compare_exchange_strong(expected, previous_version + 1);
+        }
+    }
+
 public:
     CustomPresetDataDictionary() = default;
 
-    std::vector<std::string> keys() {
-        std::lock_guard<std::mutex> lock(mutex);
+    // current content (lock free, the snapshot never changes once published)
+    [[nodiscard]] std::shared_ptr<const Snapshot> snapshot() const {
+        return std::atomic_load(&current);
+    }
+
+    [[nodiscard]] uint64_t getVersion() const { return version.load(std::memory_order_acquire); }
+
+    std::vector<std::string> keys() const {
         std::vector<std::string> keys;
-        for (const auto& pair : tensorMap) {
+        for (const auto& pair : snapshot()->tensors) {
             keys.push_back(pair.first);
         }
         return keys;
     }
 
-    std::vector<torch::Tensor> values() {
-        std::lock_guard<std::mutex> lock(mutex);
+    std::vector<torch::Tensor> values() const {
         std::vector<torch::Tensor> values;
-        for (const auto& pair : tensorMap) {
+        for (const auto& pair : snapshot()->tensors) {
             values.push_back(pair.second);
         }
         return values;
     }
 
-    std::vector<std::pair<std::string, torch::Tensor>> items() {
-        std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::pair<std::string, torch::Tensor>> items() const {
         std::vector<std::pair<std::string, torch::Tensor>> items;
-        for (const auto& pair : tensorMap) {
+        for (const auto& pair : snapshot()->tensors) {
             items.emplace_back(pair);
         }
         return items;
@@ -166,60 +552,86 @@ public:
 
     // Method to update the map (thread-safe)
     void tensor(const std::string& tensorLabel, const torch::Tensor& tensor) {
-        std::lock_guard<std::mutex> lock(mutex);
-        tensorMap[tensorLabel] = tensor;
-        // changeFlags[tensorLabel] = true;  // Mark this key as changed
+        uint64_t written_version = 0;
+        publish([&](Snapshot& next) {
+            next.tensors[tensorLabel] = tensor;
+            next.versions[tensorLabel] = written_version = next.version;
+        }, true);
+        std::lock_guard<std::mutex> lock(seen_mutex);
+        seen_versions[tensorLabel] = std::max(seen_versions[tensorLabel], written_version);
     }
 
-    // Get tensorData by label and reset the change flag for that key
+    // Get tensorData by label and mark the entry as read
     // returns  nullopt if the key is not found
     std::optional<torch::Tensor> tensor(const std::string& tensorLabel) {
-        std::lock_guard<std::mutex> lock(mutex);
-        auto it = tensorMap.find(tensorLabel);
-        if (it != tensorMap.end()) {
-            changeFlags[tensorLabel] = false;  // Reset the flag for this key
-            return it->second;
+        auto snap = snapshot();
+        auto it = snap->tensors.find(tensorLabel);
+        if (it == snap->tensors.end()) {
+            return std::nullopt;
         }
-        return std::nullopt;
+
+        if (consumed_version.load(std::memory_order_acquire) != snap->version) {
+            std::lock_guard<std::mutex> lock(seen_mutex);
+            seen_versions[tensorLabel] = snap->versions.at(tensorLabel);
+
+            // all changed entries read --> the snapshot is consumed
+            bool all_seen = std::all_of(snap->versions.begin(), snap->versions.end(), [&](const auto& entry) {
+                auto seen = seen_versions.find(entry.first);
+                return seen != seen_versions.end() && seen->second >= entry.second;
+            });
+            if (all_seen) {
+                consumed_version = snap->version;
+            }
+        }
+        return it->second;
     }
 
-    // Method to check if the content for any of the keys has changed
-    bool hasTensorDataChanged() {
-        std::lock_guard<std::mutex> lock(mutex);
-        return std::any_of(changeFlags.begin(), changeFlags.end(), [](const auto& pair) { return pair.second; });
+    // checks if the content of any of the keys has changed since it was last read (single atomic load per counter)
+    bool hasTensorDataChanged() const {
+        if (updates_in_progress.load(std::memory_order_acquire) > 0) {
+            return false;
+        }
+        return version.load(std::memory_order_acquire) != consumed_version.load(std::memory_order_acquire);
     }
 
-    // Method to access the map (thread-safe)
-    std::map<std::string, torch::Tensor>& operator()() {
-        std::lock_guard<std::mutex> lock(mutex);
-        return tensorMap;
+    // changes made between beginUpdate() and endUpdate() are only reported once the update ends
+    // (i.e. while a preset is being applied, so that the DPL sees the data and the parameters together)
+    void beginUpdate() { updates_in_progress++; }
+    void endUpdate() { updates_in_progress--; }
+
+    // current map (lock free, shares ownership of the snapshot it belongs to)
+    std::shared_ptr<const std::map<std::string, torch::Tensor>> operator()() const {
+        auto snap = snapshot();
+        return {snap, &snap->tensors};
     }
 
-    // Method to get the map (thread-safe)
+    // Method to get the map and mark all entries as read
     std::map<std::string, torch::Tensor> tensors() {
-        std::lock_guard<std::mutex> lock(mutex);
-        // Reset all change flags
-        for (auto& pair : changeFlags) {
-            pair.second = false;
+        auto snap = snapshot();
+        {
+            std::lock_guard<std::mutex> lock(seen_mutex);
+            for (const auto& [key, v] : snap->versions) {
+                seen_versions[key] = v;
+            }
         }
-        return tensorMap;
+        consumed_version = snap->version;
+        return snap->tensors;
     }
 
-    // update content from a map<string, tensor> (thread-safe)
+    // update content from a map<string, tensor> (thread-safe), all keys are reported as changed
     void copy_from_map(const std::map<std::string, torch::Tensor>& m) {
-        std::lock_guard<std::mutex> lock(mutex);
-        tensorMap = m;
-        for (const auto& pair : m) {
-            const std::string& key = pair.first;
-            changeFlags[key] = true;  // Mark all keys as changed
-        }
-        changed = true;
+        publish([&](Snapshot& next) {
+            next.tensors = m;
+            next.versions.clear();
+            for (const auto& pair : m) {
+                next.versions[pair.first] = next.version;
+            }
+        }, false);
     }
 
     // Print the map (thread-safe)
-    void printTensorMap() {
-        std::lock_guard<std::mutex> lock(mutex);
-        for (const auto& pair : tensorMap) {
+    void printTensorMap() const {
+        for (const auto& pair : snapshot()->tensors) {
             const std::string& key = pair.first;
             const torch::Tensor& t = pair.second;
             std::cout << key << ": Tensor Dim:" << t.dim() << " Size: " << t.sizes() <<
@@ -228,49 +640,37 @@ public:
     }
 
     // compare two CustomPresetDataDictionary
-    bool operator==(CustomPresetDataDictionary other) {
+    bool operator==(const CustomPresetDataDictionary& other) const {
         printTensorMap();
         other.printTensorMap();
 
-        std::lock_guard<std::mutex> lock(mutex);
-        std::lock_guard<std::mutex> lock2(other.mutex);
+        auto mine = snapshot();
+        auto theirs = other.snapshot();
 
         // check if all keys are the same
-        for (const auto& pair : tensorMap) {
-            const std::string& key = pair.first;
-            if (other.tensorMap.find(key) == other.tensorMap.end()) return false;
-        }
-
-        for (const auto& pair : other.tensorMap) {
-            const std::string& key = pair.first;
-            if (tensorMap.find(key) == tensorMap.end()) return false;
+        if (mine->tensors.size() != theirs->tensors.size()) return false;
+        for (const auto& pair : mine->tensors) {
+            if (theirs->tensors.find(pair.first) == theirs->tensors.end()) return false;
         }
 
         // check if all values are the same
-        for (const auto& pair : tensorMap) {
-            const std::string& key = pair.first;
-            const torch::Tensor& t = pair.second;
-            if (!torch::equal(t, other.tensorMap.at(key))) return false;
+        for (const auto& pair : mine->tensors) {
+            if (!torch::equal(pair.second, theirs->tensors.at(pair.first))) return false;
         }
 
         return true;
     }
 
-    // copy constructor
+    // copy constructor (the copy reports all its content as changed)
     CustomPresetDataDictionary(const CustomPresetDataDictionary& other) {
-        std::lock_guard<std::mutex> lock(other.mutex);
-        tensorMap = other.tensorMap;
-        changeFlags = other.changeFlags;
-        changed = true;
+        copy_from_map(other.snapshot()->tensors);
     }
 
     // copy assignment operator
     CustomPresetDataDictionary& operator=(const CustomPresetDataDictionary& other) {
-        std::lock_guard<std::mutex> lock(mutex);
-        std::lock_guard<std::mutex> lock2(other.mutex);
-        tensorMap = other.tensorMap;
-        changeFlags = other.changeFlags;
-        changed = true;
+        if (this != &other) {
+            copy_from_map(other.snapshot()->tensors);
+        }
         return *this;
     }
-};
\ No newline at end of file
+};
@@ -0,0 +1,137 @@
+// ============================================================================================================
+// ==========          NeuralMidiFX Inference Host                    =========================================
+// ============================================================================================================
+/*
+ * Helper process hosting the TorchScript model for the OutOfProcessBackend (see InferenceBackend.h).
+ * Launched by the plugin as:
+ *
+ *      NeuralMidiFXInferenceHost <segment name> <parent pid>
+ *
+ * Serves the requests found in the shared memory segment created by the plugin until it receives a Shutdown
+ * request or the parent process is gone. libtorch is only loaded in this process.
+ */
+
+#include "../Includes/InferenceHostProtocol.h"
+#include "../Includes/InferenceBackend.h"
+
+#include <iostream>
+#include <sstream>
+
+#if defined(_WIN32) || defined(_WIN64)
+#   define WIN32_LEAN_AND_MEAN
+#   define NOMINMAX
+#   include <Windows.h>
+#else
+#   include <csignal>
+#   include <unistd.h>
+#endif
+
+using namespace inference_host;
+
+static bool isProcessAlive(long pid) {
+#if defined(_WIN32) || defined(_WIN64)
+    auto process = OpenProcess(SYNCHRONIZE, FALSE, (DWORD) pid);
+    if (process == nullptr) {
+        return false;
+    }
+    auto alive = WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+    CloseHandle(process);
+    return alive;
+#else
+    return getppid() == (pid_t) pid || kill((pid_t) pid, 0) == 0;
+#endif
+}
+
+static Message handleRequest(TorchScriptBackend &backend, const Message &request) {
+    Message response;
+    response.kind = request.kind;
+    response.request_id = request.request_id;
+
+    try {
+        switch (request.kind) {
+            case Kind::Load: {
+                if (!backend.load(request.text)) {
+                    throw std::runtime_error("Failed to load " + request.text);
+                }
+                std::stringstream methods;
+                for (const auto &name : backend.getMethodNames()) { methods << name << ","; }
+                response.text = methods.str();
+                break;
+            }
+            case Kind::Run: {
+                c10::InferenceMode guard;
+                response.tensors = backend.run(request.text, request.tensors);
+                break;
+            }
+            case Kind::SetNumThreads:
+                backend.setNumThreads((int) request.int_arg);
+                break;
+            case Kind::Shutdown:
+                break;
+        }
+    } catch (const std::exception &e) {
+        response.status = Status::Error;
+        response.text = e.what();
+        response.tensors.clear();
+    }
+    return response;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        std::cerr << "usage: " << argv[0] << " <segment name> <parent pid>" << std::endl;
+        return 1;
+    }
+
+    auto parent_pid = std::stol(argv[2]);
+
+    SharedMemorySegment segment;
+    if (!segment.open(argv[1], segmentSize())) {
+        std::cerr << "Could not open shared memory segment " << argv[1] << std::endl;
+        return 1;
+    }
+
+    auto header = static_cast<SegmentHeader *>(segment.getData());
+    if (header->magic != segment_magic || header->capacity != ring_capacity) {
+        std::cerr << "Incompatible shared memory segment " << argv[1] << std::endl;
+        return 1;
+    }
+
+    SharedMemoryRing requests;
+    SharedMemoryRing responses;
+    requests.attach(static_cast<uint8_t *>(segment.getData()) + requestRingOffset());
+    responses.attach(static_cast<uint8_t *>(segment.getData()) + responseRingOffset());
+
+    TorchScriptBackend backend;
+    std::vector<uint8_t> bytes;
+
+    while (true) {
+        if (!requests.waitForData(1000)) {
+            if (!isProcessAlive(parent_pid)) {
+                return 0;
+            }
+            continue;
+        }
+
+        while (requests.read(bytes)) {
+            Message request;
+            if (!request.deserialize(bytes)) {
+                continue;
+            }
+
+            auto response = handleRequest(backend, request);
+            response.serialize(bytes);
+            if (!responses.write(bytes.data(), (uint32_t) bytes.size())) {
+                response.status = Status::Error;
+                response.text = fitsInRing(bytes.size()) ? "Response ring is full" : messageTooLarge(bytes.size());
+                response.tensors.clear();
+                response.serialize(bytes);
+                responses.write(bytes.data(), (uint32_t) bytes.size());
+            }
+
+            if (request.kind == Kind::Shutdown) {
+                return 0;
+            }
+        }
+    }
+}
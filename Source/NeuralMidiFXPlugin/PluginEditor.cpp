@@ -76,7 +76,7 @@ NeuralMidiFXPluginEditor::NeuralMidiFXPluginEditor(NeuralMidiFXPluginProcessor&
     // Iteratively generate tabs. For each tab, a parent UI component of  will be created.
     for (int i = 0; i < numTabs; i++)
     {
-        currentTab = UIObjects::Tabs::tabList[i];
+        currentTab = UIObjects::Tabs::getTabList()[i];
         tabName = std::get<0>(currentTab);
 
         paramComponentPtr = new ParameterComponent(currentTab, sharedHoverText.get());
@@ -21,7 +21,7 @@ public:
 
     juce::TabbedComponent tabs;
 
-    const int numTabs = (int) UIObjects::Tabs::tabList.size();
+    const int numTabs = (int) UIObjects::Tabs::getTabList().size();
 
     ParameterComponent* paramComponentPtr;
     std::vector<ParameterComponent*> paramComponentVector;
@@ -29,21 +29,15 @@ NeuralMidiFXPluginProcessor::NeuralMidiFXPluginProcessor() : apvts(
 
     // Populate Pianoroll Data
     // ----------------------------------------------------------------------------------
-    auto tabList = UIObjects::Tabs::tabList;
+    // (the displays are listed in generated_settings::parameters, so the json isn't parsed here)
+    using generated_settings::ParamKind;
 
     // populate midiVisualizersData
     {
-        int count = 0;
         std::vector<std::string> param_ids;
-
-        for (auto tab_list: tabList)
-        {
-            auto midiVisualizers = std::get<6>(tab_list);
-            for (auto midiVisualizerJson: midiVisualizers)
-            {
-                param_ids.push_back(
-                    label2ParamID(midiVisualizerJson["label"].get<std::string>()));
-                count++;
+        for (const auto& descriptor : generated_settings::parameters) {
+            if (descriptor.kind == ParamKind::MidiDisplay) {
+                param_ids.push_back(label2ParamID(descriptor.label));
             }
         }
 
@@ -52,17 +46,10 @@ NeuralMidiFXPluginProcessor::NeuralMidiFXPluginProcessor() : apvts(
 
     // populate audioVisualizersData
     {
-        int count = 0;
         std::vector<std::string> param_ids;
-
-        for (auto tab_list: tabList)
-        {
-            auto audioVisualizers = std::get<7>(tab_list);
-            for (auto audioVisualizerJson: audioVisualizers)
-            {
-                param_ids.push_back(
-                    label2ParamID(audioVisualizerJson["label"].get<std::string>()));
-                count++;
+        for (const auto& descriptor : generated_settings::parameters) {
+            if (descriptor.kind == ParamKind::AudioDisplay) {
+                param_ids.push_back(label2ParamID(descriptor.label));
             }
         }
 
@@ -270,6 +257,64 @@ std::optional<juce::MidiMessage> NeuralMidiFXPluginProcessor::getMessageIfToBePl
 }
 
 
+// offset applied to the times of received streams/edits according to the current playback policy
+double NeuralMidiFXPluginProcessor::getPlaybackTimeAdjustment() const {
+    if (playbackPolicies.IsPlaybackPolicy_RelativeToNow()) {
+        return time_anchor_for_playback.getTimeWithUnitType(playbackPolicies.getTimeUnitIndex());
+    }
+    if (playbackPolicies.IsPlaybackPolicy_RelativeToPlaybackStart()) {
+        return playhead_start_time.getTimeWithUnitType(playbackPolicies.getTimeUnitIndex());
+    }
+    return 0.0;
+}
+
+// keeps only the events allowed by the retention policy (the latest events are always the ones kept)
+// only called when a new stream is merged, so the playback loop itself only ever sees a bounded sequence
+void NeuralMidiFXPluginProcessor::applyPlaybackRetentionPolicy(time_ now_, double fs, double qpm) {
+    auto num_events = playbackMessageSequence.getNumEvents();
+    // when looping, events behind the playhead are played again on the next pass, so nothing is evicted
+    if (!playbackPolicies.IsRetentionPolicyActive() || playbackPolicies.getLoopDuration() > 0 || num_events == 0) {
+        numRetainedPlaybackEvents = (uint64_t) num_events;
+        return;
+    }
+
+    // first event to keep (the sequence is sorted by time)
+    int first_kept = 0;
+
+    // events that are yet to be played are never evicted, even if there are more than N of them
+    if (playbackPolicies.getRetentionEvents() > 0) {
+        auto first_unplayed = playbackMessageSequence.getNextIndexAtTime(
+            now_.getTimeWithUnitType(playbackPolicies.getTimeUnitIndex()));
+        first_kept = std::max(first_kept,
+                              std::min(num_events - playbackPolicies.getRetentionEvents(), first_unplayed));
+    }
+
+    if (playbackPolicies.getRetentionBeats() > 0 && qpm > 0) {
+        auto window = playbackPolicies.getRetentionBeats();
+        switch (playbackPolicies.getTimeUnitIndex()) {
+            case 1: window *= fs * 60.0 / qpm; break;      // samples
+            case 2: window *= 60.0 / qpm; break;           // seconds
+            default: break;                                // QuarterNotes
+        }
+        auto cutoff = now_.getTimeWithUnitType(playbackPolicies.getTimeUnitIndex()) - window;
+        first_kept = std::max(first_kept, playbackMessageSequence.getNextIndexAtTime(cutoff));
+    }
+
+    // each deleteEvent shifts the rest of the sequence, so only a bounded number of events is evicted per call
+    // (the remainder is evicted on the following merges/edits, as first_kept is recomputed every time)
+    auto num_evicted = std::min(first_kept, max_playback_evictions_per_merge);
+    if (num_evicted > 0) {
+        // deleted in place (back to front), nothing is allocated on the audio thread
+        // note offs are re-matched by the caller (updateMatchedPairs)
+        for (int i = num_evicted - 1; i >= 0; i--) {
+            playbackMessageSequence.deleteEvent(i, false);
+        }
+        numEvictedPlaybackEvents += (uint64_t) num_evicted;
+    }
+
+    numRetainedPlaybackEvents = (uint64_t) playbackMessageSequence.getNumEvents();
+}
+
 void NeuralMidiFXPluginProcessor::sendReceivedInputsAsEvents(
         MidiBuffer &midiMessages, const Optional<AudioPlayHead::PositionInfo> &Pinfo,
         double fs, int buffSize) {
@@ -280,7 +325,7 @@ void NeuralMidiFXPluginProcessor::sendReceivedInputsAsEvents(
         if (!last_frame_meta_data.isPlaying() != !Pinfo->getIsPlaying()) {
             // if just started, register the playhead starting position
             if ((!last_frame_meta_data.isPlaying()) && Pinfo->getIsPlaying()) {
-                if (print_start_stop_times) {
+                if constexpr (print_start_stop_times) {
                     PrintMessage("Started playing");
                 }
                 playhead_start_time = time_{*Pinfo->getTimeInSamples(),
@@ -301,7 +346,7 @@ void NeuralMidiFXPluginProcessor::sendReceivedInputsAsEvents(
                 // if just stopped, register the playhead stopping position
                 auto frame_meta_data = EventFromHost {Pinfo, fs,
                                                       buffSize, false};
-                if (print_start_stop_times) { PrintMessage("Stopped playing"); }
+                if constexpr (print_start_stop_times) { PrintMessage("Stopped playing"); }
                 frame_meta_data.setPlaybackStoppedEvent();
                 NMP2DPL_Event_Que->push(frame_meta_data);
                 last_frame_meta_data = frame_meta_data;     // reset last frame meta data
@@ -316,12 +361,12 @@ void NeuralMidiFXPluginProcessor::sendReceivedInputsAsEvents(
         } else {
             // if still playing, register the playhead position
             if (Pinfo->getIsPlaying()) {
-                if (print_new_buffer_started) { PrintMessage("New Buffer Arrived"); }
+                if constexpr (print_new_buffer_started) { PrintMessage("New Buffer Arrived"); }
                 auto frame_meta_data = EventFromHost {Pinfo, fs,
                                                       buffSize,
                                                       false};
-                if (SendEventAtBeginningOfNewBuffers_FLAG) {
-                    if (SendEventForNewBufferIfMetadataChanged_FLAG) {
+                if constexpr (SendEventAtBeginningOfNewBuffers_FLAG) {
+                    if constexpr (SendEventForNewBufferIfMetadataChanged_FLAG) {
                         if (frame_meta_data.getBufferMetaData() !=
                             last_frame_meta_data.getBufferMetaData()) {
                             NMP2DPL_Event_Que->push(frame_meta_data);
@@ -385,16 +430,17 @@ void NeuralMidiFXPluginProcessor::sendReceivedInputsAsEvents(
                 auto midiEvent = EventFromHost {Pinfo, fs, buffSize, msg};
 
                 // check if new bar event exists && it is before the current midi event
-                if (NewBarEvent.has_value() && SendNewBarEvents_FLAG) {
-                    if (midiEvent.Time().inSamples() >= NewBarEvent->Time().inSamples()) {
+                if constexpr (SendNewBarEvents_FLAG) {
+                    if (NewBarEvent.has_value() && midiEvent.Time().inSamples() >= NewBarEvent->Time().inSamples()) {
                         NMP2DPL_Event_Que->push(*NewBarEvent);
                         NewBarEvent = std::nullopt;
                     }
                 }
 
                 // check if a specified number of whole notes has passed
-                if (NewTimeShiftEvent.has_value() && SendTimeShiftEvents_FLAG) {
-                    if (midiEvent.Time().inSamples() >= NewTimeShiftEvent->Time().inSamples()) {
+                if constexpr (SendTimeShiftEvents_FLAG) {
+                    if (NewTimeShiftEvent.has_value() &&
+                        midiEvent.Time().inSamples() >= NewTimeShiftEvent->Time().inSamples()) {
                         NMP2DPL_Event_Que->push(*NewTimeShiftEvent);
                         NewTimeShiftEvent = std::nullopt;
                     }
@@ -402,7 +448,7 @@ void NeuralMidiFXPluginProcessor::sendReceivedInputsAsEvents(
 
                 if (midiEvent.isMidiMessageEvent()) {
                     if (midiEvent.isNoteOnEvent()) {
-                        if (!FilterNoteOnEvents_FLAG) {
+                        if constexpr (!FilterNoteOnEvents_FLAG) {
                             NMP2DPL_Event_Que->push(midiEvent);
                         }
                         NoteOnOffReceived = true;
@@ -414,7 +460,7 @@ void NeuralMidiFXPluginProcessor::sendReceivedInputsAsEvents(
                     }
 
                     if (midiEvent.isNoteOffEvent()) {
-                        if (!FilterNoteOffEvents_FLAG) {
+                        if constexpr (!FilterNoteOffEvents_FLAG) {
                             NMP2DPL_Event_Que->push(midiEvent);
                         }
                         NoteOnOffReceived = true;
@@ -429,20 +475,24 @@ void NeuralMidiFXPluginProcessor::sendReceivedInputsAsEvents(
                         NMP2GUI_IncomingMessageSequence->push(incoming_messages_sequence);
                     }
                     if (midiEvent.isCCEvent()) {
-                        if (!FilterCCEvents_FLAG) { NMP2DPL_Event_Que->push(midiEvent); }
+                        if constexpr (!FilterCCEvents_FLAG) { NMP2DPL_Event_Que->push(midiEvent); }
                     }
                 }
             }
         }
 
         // if there is a new bar event, && hasn't been sent yet, send it
-        if (NewBarEvent.has_value() && SendNewBarEvents_FLAG) {
-            NMP2DPL_Event_Que->push(*NewBarEvent);
-            NewBarEvent = std::nullopt;
+        if constexpr (SendNewBarEvents_FLAG) {
+            if (NewBarEvent.has_value()) {
+                NMP2DPL_Event_Que->push(*NewBarEvent);
+                NewBarEvent = std::nullopt;
+            }
         }
-        if (NewTimeShiftEvent.has_value() && SendTimeShiftEvents_FLAG) {
-            NMP2DPL_Event_Que->push(*NewTimeShiftEvent);
-            NewTimeShiftEvent = std::nullopt;
+        if constexpr (SendTimeShiftEvents_FLAG) {
+            if (NewTimeShiftEvent.has_value()) {
+                NMP2DPL_Event_Que->push(*NewTimeShiftEvent);
+                NewTimeShiftEvent = std::nullopt;
+            }
         }
     }
 }
@@ -469,230 +519,56 @@ juce::AudioProcessorValueTreeState::ParameterLayout NeuralMidiFXPluginProcessor:
 
     int version_hint = 1;
 
-    size_t numTabs = UIObjects::Tabs::tabList.size();
-    size_t numSliders;
-    size_t numRotaries;
-    size_t numButtons;
-    size_t numhsliders;
-    size_t numComboBoxes;
-    size_t numTriangleSliders;
-
-    tab_tuple tabTuple;
-
-    slider_list sliderList;
-    rotary_list rotaryList;
-    button_list buttonList;
-    hslider_list hsliderList;
-    comboBox_list comboboxList;
-    triangleSliders_list triangleSlidersList;
-
-    for (size_t j = 0; j < numTabs; j++) {
-        tabTuple = UIObjects::Tabs::tabList[j];
-
-        sliderList = std::get<1>(tabTuple);
-        rotaryList = std::get<2>(tabTuple);
-        buttonList = std::get<3>(tabTuple);
-        hsliderList = std::get<4>(tabTuple);
-        comboboxList = std::get<5>(tabTuple);
-        triangleSlidersList = std::get<10>(tabTuple);
-
-        numSliders = sliderList.size();
-        numRotaries = rotaryList.size();
-        numButtons = buttonList.size();
-        numhsliders = hsliderList.size();
-        numComboBoxes = comboboxList.size();
-        numTriangleSliders = triangleSlidersList.size();
-
-        // Sliders
-        for (size_t i = 0; i < numSliders; ++i) {
-            auto sliderJson = sliderList[i];
-
-            auto name = sliderJson["label"].get<std::string>();
-            auto minValue = sliderJson["min"].get<float>();
-            auto maxValue = sliderJson["max"].get<float>();
-            auto initValue = sliderJson["default"].get<float>();
-
-
-            // Param ID will read "Slider" + [tab, item] i.e. 'Slider_13"
-            auto paramIDstr = label2ParamID(name);
-            juce::ParameterID paramID = juce::ParameterID(paramIDstr, version_hint);
-
-            bool alreadyExists = false;
-            for (const auto& param_id : param_ids_so_far) {
-                if (param_id == paramIDstr) {
-                    alreadyExists = true;
-                    break;
-                }
-            }
-
-            if (!alreadyExists) {
-                layout.add (std::make_unique<juce::AudioParameterFloat> (paramID, name, minValue, maxValue, initValue));
-                param_ids_so_far.push_back(paramIDstr);
-            } else {
-                cout << "[settings.json] WARNING: Duplicate paramID: " << paramIDstr << ". \tCheck if intentional!" << endl;
-            }
-
+    // the widgets of the tabs are compiled into generated_settings::parameters (see GenerateSettingsHeader.cmake),
+    // in the order the parameters were always added, so no json is parsed here (i.e. during host plugin scans)
+    using generated_settings::ParamKind;
+    for (const auto& descriptor : generated_settings::parameters) {
+        // displays (and the widgets only listed for the preset exclusions) have no apvts parameter
+        if (descriptor.kind == ParamKind::MidiDisplay || descriptor.kind == ParamKind::AudioDisplay ||
+            descriptor.kind == ParamKind::None) {
+            continue;
         }
 
-        // Rotaries
-        for (size_t i = 0; i < numRotaries; ++i) {
-            auto rotaryJson = rotaryList[i];
-
-            auto name = rotaryJson["label"].get<std::string>();
-            auto minValue = rotaryJson["min"].get<float>();
-            auto maxValue = rotaryJson["max"].get<float>();
-            auto initValue = rotaryJson["default"].get<float>();
-
-            auto paramIDstr = label2ParamID(name);
-            juce::ParameterID paramID = juce::ParameterID(paramIDstr, version_hint);
+        std::string name = descriptor.label;
+        auto paramIDstr = label2ParamID(name);
+        juce::ParameterID paramID = juce::ParameterID(paramIDstr, version_hint);
 
-            bool alreadyExists = false;
-            for (const auto& param_id : param_ids_so_far) {
-                if (param_id == paramIDstr) {
-                    alreadyExists = true;
-                    break;
-                }
-            }
-
-            if (!alreadyExists) {
-                layout.add (std::make_unique<juce::AudioParameterFloat> (paramID, name, minValue, maxValue, initValue));
-                param_ids_so_far.push_back(paramIDstr);
-            } else {
-                cout << "[settings.json] WARNING: Duplicate paramID: " << paramIDstr << ". Check if intentional!" << endl;
-            }
-        }
-
-        // Buttons
-        for (size_t i = 0; i < numButtons; ++i) {
-            auto buttonJson = buttonList[i];
-
-            auto name = buttonJson["label"].get<std::string>();
-
-            auto paramIDstr = label2ParamID(name);
-            juce::ParameterID paramID = juce::ParameterID(paramIDstr, version_hint);
-
-            bool alreadyExists = false;
-            for (const auto& param_id : param_ids_so_far) {
-                if (param_id == paramIDstr) {
-                    alreadyExists = true;
-                    break;
-                }
-            }
-
-            if (!alreadyExists) {
-                layout.add (std::make_unique<juce::AudioParameterInt> (paramID, name, 0, 1, 0));
-                param_ids_so_far.push_back(paramIDstr);
-            } else {
-                cout << "[settings.json] WARNING: Duplicate paramID: " << paramIDstr << ". Check if intentional!" << endl;
-            }
-        }
-
-        // Vertical Sliders
-        for (size_t i = 0; i < numhsliders; ++i) {
-            auto sliderJson = hsliderList[i];
-
-            auto name = sliderJson["label"].get<std::string>();
-            auto minValue = sliderJson["min"].get<float>();
-            auto maxValue = sliderJson["max"].get<float>();
-            auto initValue = sliderJson["default"].get<float>();
-
-            auto paramIDstr = label2ParamID(name);
-            juce::ParameterID paramID = juce::ParameterID(paramIDstr, version_hint);
-
-            bool alreadyExists = false;
-            for (const auto& param_id : param_ids_so_far) {
-                if (param_id == paramIDstr) {
-                    alreadyExists = true;
-                    break;
-                }
-            }
-
-            if (!alreadyExists) {
-                layout.add (std::make_unique<juce::AudioParameterFloat> (paramID, name, minValue, maxValue, initValue));
-                param_ids_so_far.push_back(paramIDstr);
-            } else {
-                cout << "[settings.json] WARNING: Duplicate paramID: " << paramIDstr << ". Check if intentional!" << endl;
+        bool alreadyExists = false;
+        for (const auto& param_id : param_ids_so_far) {
+            if (param_id == paramIDstr) {
+                alreadyExists = true;
+                break;
             }
         }
 
-        // Combo Boxes
-        for (size_t i = 0; i < numComboBoxes; ++i) {
-            auto comboboxJson = comboboxList[i];
-
-            auto name = comboboxJson["label"].get<std::string>();
-            auto items = comboboxJson["items"].get<std::vector<std::string>>();
-            auto paramIDstr = label2ParamID(name);
-            juce::ParameterID paramID = juce::ParameterID(paramIDstr, version_hint);
-
-            bool alreadyExists = false;
-            for (const auto& param_id : param_ids_so_far) {
-                if (param_id == paramIDstr) {
-                    alreadyExists = true;
-                    break;
-                }
-            }
-
-            if (!alreadyExists) {
-                layout.add (std::make_unique<juce::AudioParameterInt> (paramID, name, 0, items.size() - 1, 0));
-                param_ids_so_far.push_back(paramIDstr);
-            } else {
-                cout << "[settings.json] WARNING: Duplicate paramID: " << paramIDstr << ". Check if intentional!" << endl;
-            }
+        if (alreadyExists) {
+            cout << "[settings.json] WARNING: Duplicate paramID: " << paramIDstr << ". Check if intentional!" << endl;
+            continue;
         }
 
-        // Triangle Sliders
-        for (size_t i = 0; i < numTriangleSliders; ++i) {
-            auto json = triangleSlidersList[i];
-
-            if (!json.contains("DistanceFromBottomLeftCornerSlider") || !json.contains("HeightSlider")) {
-                cout << "ERROR: Triangle Slider missing DistanceFromBottomLeftCornerSlider or HeightSlider" << endl;
-                continue;
-            }
-
-            auto DistanceFromBottomLeftCornerSlider = json["DistanceFromBottomLeftCornerSlider"].get<std::string>();
-            auto HeightSlider = json["HeightSlider"].get<std::string>();
-
-            auto paramAIDstr = label2ParamID(DistanceFromBottomLeftCornerSlider);
-            auto paramBIDstr = label2ParamID(HeightSlider);
-
-            juce::ParameterID paramAID = juce::ParameterID(paramAIDstr, version_hint);
-            juce::ParameterID paramBID = juce::ParameterID(paramBIDstr, version_hint);
-
-            bool alreadyExists = false;
-            for (const auto& param_id : param_ids_so_far) {
-                if (label2ParamID(param_id) == paramAIDstr) {
-                    alreadyExists = true;
-                    break;
-                }
-            }
-
-            if (!alreadyExists) {
-                layout.add (std::make_unique<juce::AudioParameterFloat> (paramAID, paramAIDstr, 0, 1, 0));
-                param_ids_so_far.push_back(paramAIDstr);
-            } else {
-                cout << "[settings.json] WARNING: Duplicate paramID: " << paramAIDstr << ". Check if intentional!" << endl;
-            }
-
-            alreadyExists = false;
-            for (const auto& param_id : param_ids_so_far) {
-                if (label2ParamID(param_id) == paramBIDstr) {
-                    alreadyExists = true;
-                    break;
-                }
-            }
-
-            if (!alreadyExists) {
-                layout.add (std::make_unique<juce::AudioParameterFloat> (paramBID, paramBIDstr, 0, 1, 0));
-                param_ids_so_far.push_back(paramBIDstr);
-            } else {
-                cout << "[settings.json] WARNING: Duplicate paramID: " << paramBIDstr << ". Check if intentional!" << endl;
-            }
+        switch (descriptor.kind) {
+            case ParamKind::Slider:     // vertical and horizontal
+            case ParamKind::Rotary:
+                layout.add (std::make_unique<juce::AudioParameterFloat> (
+                    paramID, name, (float) descriptor.min, (float) descriptor.max, (float) descriptor.default_value));
+                break;
+            case ParamKind::Button:
+                layout.add (std::make_unique<juce::AudioParameterInt> (paramID, name, 0, 1, 0));
+                break;
+            case ParamKind::ComboBox:
+                layout.add (std::make_unique<juce::AudioParameterInt> (paramID, name, 0, descriptor.num_items - 1, 0));
+                break;
+            case ParamKind::TriangleSliderAxis:
+                layout.add (std::make_unique<juce::AudioParameterFloat> (paramID, paramIDstr, 0, 1, 0));
+                break;
+            default:
+                break;
         }
-
+        param_ids_so_far.push_back(paramIDstr);
     }
 
     // check if standalone mode enabled
-    if (UIObjects::StandaloneTransportPanel::enable) {
+    if (generated_settings::StandaloneTransportPanel::enable) {
         // add standalone only parameters
         layout.add(
             std::make_unique<juce::AudioParameterInt>(
@@ -730,30 +606,29 @@ juce::AudioProcessorValueTreeState::ParameterLayout NeuralMidiFXPluginProcessor:
     return layout;
 }
 
-inline std::string generateTempFileName() {
-    std::time_t t = std::time(nullptr);
-    std::tm tm = *std::localtime(&t);
-    std::ostringstream oss;
-
-    oss << std::put_time(&tm, "%Y-%m-%d-%H-%M-%S");
-    auto time_str = oss.str();
-    auto temp_file_name = time_str + ".preset";
-
-    return temp_file_name;
-}
-
 void NeuralMidiFXPluginProcessor::getStateInformation(juce::MemoryBlock &destData) {
-    auto state = apvts.copyState();
-    std::unique_ptr<juce::XmlElement> xml(state.createXml());
-
-    // Generate and save the file path
-    auto filePath = generateTempFileName();
-    xml->setAttribute("filePath", filePath); // Add the file path as an attribute
-    copyXmlToBinary(*xml, destData);
+    // apvts and the custom preset tensors in a single binary chunk (see PluginStateChunk.h)
+    plugin_state_chunk::write(apvts.copyState(), deploymentThread->CustomPresetData->snapshot()->tensors, destData);
 }
 
 void NeuralMidiFXPluginProcessor::setStateInformation(const void *data, int sizeInBytes) {
+    if (plugin_state_chunk::hasMagic(data, (size_t) sizeInBytes)) {
+        auto state = plugin_state_chunk::read(data, (size_t) sizeInBytes);
+        if (state.has_value() && state->apvts.hasType(apvts.state.getType())) {
+            // the preset selected in the restored state must not be reloaded over the restored data
+            auto preset = state->apvts.getChildWithProperty("id", juce::String(label2ParamID("Preset")));
+            if (preset.isValid()) {
+                apvtsMediatorThread->adoptRestoredState((int) preset.getProperty("value"));
+            }
+            apvts.replaceState(state->apvts);
+            deploymentThread->CustomPresetData->copy_from_map(state->tensors);
+        } else {
+            std::cout << "Failed to restore the plugin state" << std::endl;
+        }
+        return;
+    }
 
+    // chunks saved before the binary format (apvts xml only)
     std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
     if (xmlState != nullptr) {
         if (xmlState->hasTagName(apvts.state.getType())) {
@@ -828,23 +703,58 @@ void NeuralMidiFXPluginProcessor::processBlock(juce::AudioBuffer<float> &buffer,
              {
                 PrintMessage(" New Sequence of Generations Received");
              }
-             double time_adjustment = 0.0;
-             if (playbackPolicies.IsPlaybackPolicy_RelativeToAbsoluteZero()) {
-                time_adjustment = 0.0;
+             double time_adjustment = getPlaybackTimeAdjustment();
+             // update according to policy (clearing already taken care of above)
+             // if nothing needs to be merged, the received sequence is taken over without copying
+             auto& newSequence = event->getNewPlaybackSequence().getJuceMidiMessageSequence();
+             if (playbackMessageSequence.getNumEvents() == 0 && time_adjustment == 0.0) {
+                playbackMessageSequence.swapWith(newSequence);
+             } else {
+                playbackMessageSequence.addSequence(newSequence, time_adjustment);
              }
-             else if (playbackPolicies.IsPlaybackPolicy_RelativeToNow()) {
-                time_adjustment = time_anchor_for_playback.getTimeWithUnitType(
-                    playbackPolicies.getTimeUnitIndex());
-             } else if (playbackPolicies.IsPlaybackPolicy_RelativeToPlaybackStart()) {
-                time_adjustment = playhead_start_time.getTimeWithUnitType(
-                    playbackPolicies.getTimeUnitIndex());
+             if (Pinfo.hasValue() && Pinfo->getPpqPosition().hasValue()) {
+                applyPlaybackRetentionPolicy(
+                    time_{*Pinfo->getTimeInSamples(), *Pinfo->getTimeInSeconds(), *Pinfo->getPpqPosition()},
+                    fs, Pinfo->getBpm().orFallback(120.0));
              }
-             // update according to policy (clearing already taken care of above)
-             playbackMessageSequence.addSequence(
-                 event->getNewPlaybackSequence().getAsJuceMidMessageSequence(),
-                 time_adjustment);
              playbackMessageSequence.updateMatchedPairs();
-             generationsToDisplay.setSequence(playbackMessageSequence);
+
+             // the new stream already uses the latest note mapping
+             playbackNoteRemap = NoteRemapTable();
+             generationsToDisplay.setSequence(playbackMessageSequence, playbackNoteRemap);
+        }
+
+        // apply incremental edits to the current stream
+        if (event->IsPlaybackSequenceEdit())
+        {
+             auto now = -std::numeric_limits<double>::max();
+             if (Pinfo.hasValue() && Pinfo->getPpqPosition().hasValue()) {
+                now = time_{*Pinfo->getTimeInSamples(), *Pinfo->getTimeInSeconds(), *Pinfo->getPpqPosition()}
+                          .getTimeWithUnitType(playbackPolicies.getTimeUnitIndex());
+             }
+             event->getPlaybackSequenceEdit().applyTo(playbackMessageSequence, getPlaybackTimeAdjustment(), now);
+             if (Pinfo.hasValue() && Pinfo->getPpqPosition().hasValue()) {
+                applyPlaybackRetentionPolicy(
+                    time_{*Pinfo->getTimeInSamples(), *Pinfo->getTimeInSeconds(), *Pinfo->getPpqPosition()},
+                    fs, Pinfo->getBpm().orFallback(120.0));
+             }
+             playbackMessageSequence.updateMatchedPairs();
+             generationsToDisplay.setSequence(playbackMessageSequence, playbackNoteRemap);
+        }
+
+        // remap the notes of the current stream (the stream itself is kept)
+        if (event->IsNoteRemap())
+        {
+             const auto& newRemap = event->getNoteRemapTable();
+
+             // notes that are remapped may be sounding with the previous mapping
+             for (int i = 0; i < 128; i++) {
+                if (playbackNoteRemap.get(i) != newRemap.get(i)) {
+                    tempBuffer.addEvent(juce::MidiMessage::noteOff(1, playbackNoteRemap.get(i)), 0);
+                }
+             }
+             playbackNoteRemap = newRemap;
+             generationsToDisplay.setNoteRemap(playbackNoteRemap);    // remapped by the gui when displayed
         }
     } else {
         event = std::nullopt;
@@ -989,6 +899,9 @@ void NeuralMidiFXPluginProcessor::processBlock(juce::AudioBuffer<float> &buffer,
                     frame_now, msg->message,
                     buffSize, fs, *Pinfo->getBpm());
                 if (msg_to_play.has_value()) {
+                    if (msg_to_play->isNoteOnOrOff()) {
+                        msg_to_play->setNoteNumber(playbackNoteRemap.get(msg_to_play->getNoteNumber()));
+                    }
                     std::stringstream ss;
                     ss << "Playing: " << msg->message.getDescription() << " at time: " << msg->message.getTimeStamp();
                     PrintMessage(ss.str());
@@ -8,6 +8,7 @@
 #include "../Includes/APVTSMediatorThread.h"
 #include "../Includes/LockFreeQueue.h"
 #include "../Includes/GenerationEvent.h"
+#include "../Includes/PluginStateChunk.h"
 #include "../Includes/APVTSMediatorThread.h"
 #include <chrono>
 #include <mutex>
@@ -23,15 +24,29 @@ private:
     double qpm {-1};
     double playhead_pos {0};
 
+    // the note remapping is published along with the sequence and applied by the reader (getSequence()), so the
+    // audio thread never has to copy the sequence just to remap it
+    NoteRemapTable note_remap{};
+    bool sequence_changed{false};
+
 public:
     PlaybackPolicies policy;
     juce::MidiMessageSequence sequence_to_display;
     std::mutex mutex;
 
 
-    void setSequence(const juce::MidiMessageSequence& sequence) {
+    void setSequence(const juce::MidiMessageSequence& sequence, const NoteRemapTable& remap) {
         std::lock_guard<std::mutex> lock(mutex);
         sequence_to_display = sequence;
+        note_remap = remap;
+        sequence_changed = true;
+    }
+
+    // only the mapping changed, the sequence is redisplayed with the new mapping
+    void setNoteRemap(const NoteRemapTable& remap) {
+        std::lock_guard<std::mutex> lock(mutex);
+        note_remap = remap;
+        sequence_changed = true;
     }
 
     void setFs(double fs_) {
@@ -55,15 +70,30 @@ public:
         policy = policy_;
     }
 
+    // returns the sequence (with the note remapping applied) if it changed since the last call
     std::optional<juce::MidiMessageSequence> getSequence() {
-        std::lock_guard<std::mutex> lock(mutex);
-        juce::MidiMessageSequence sequence_to_display_copy{sequence_to_display};
-        sequence_to_display.clear();
-        if (sequence_to_display_copy.getNumEvents() > 0) {
-            return sequence_to_display_copy;
-        } else {
+        juce::MidiMessageSequence sequence_to_display_copy;
+        NoteRemapTable remap;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!sequence_changed) {
+                return std::nullopt;
+            }
+            sequence_changed = false;
+            sequence_to_display_copy = sequence_to_display;
+            remap = note_remap;
+        }
+        if (sequence_to_display_copy.getNumEvents() == 0) {
             return std::nullopt;
         }
+        if (!remap.isIdentity()) {
+            for (auto &msg: sequence_to_display_copy) {
+                if (msg->message.isNoteOnOrOff()) {
+                    msg->message.setNoteNumber(remap.get(msg->message.getNoteNumber()));
+                }
+            }
+        }
+        return sequence_to_display_copy;
     }
 
     std::optional<PlaybackPolicies> getPolicy() {
@@ -203,8 +233,13 @@ public:
     // Playback Data
     PlaybackPolicies playbackPolicies{};
     juce::MidiMessageSequence playbackMessageSequence{};
+    NoteRemapTable playbackNoteRemap{};     // applied to the notes of playbackMessageSequence when played
     time_ time_anchor_for_playback{};
 
+    // retention counters (see PlaybackPolicies::SetRetentionPolicy_*)
+    [[nodiscard]] uint64_t getNumRetainedPlaybackEvents() const { return numRetainedPlaybackEvents; }
+    [[nodiscard]] uint64_t getNumEvictedPlaybackEvents() const { return numEvictedPlaybackEvents; }
+
     // mutex protected structures for interacting with the GUI
     GenerationsToDisplay generationsToDisplay{};
     mutex playbackAnchorMutex;
@@ -229,6 +264,14 @@ private:
             time_ now_, const juce::MidiMessage &msg,
             int buffSize, double fs, double qpm) const;
 
+    [[nodiscard]] double getPlaybackTimeAdjustment() const;
+
+    // evicts the events of playbackMessageSequence that fall outside the retention policy
+    void applyPlaybackRetentionPolicy(time_ now_, double fs, double qpm);
+    static constexpr int max_playback_evictions_per_merge = 64;   // bounds the work done on the audio thread
+    std::atomic<uint64_t> numRetainedPlaybackEvents{0};   // events in the playback sequence after the last merge
+    std::atomic<uint64_t> numEvictedPlaybackEvents{0};    // total events evicted so far
+
     //  midiBuffer to fill up with generated data
     juce::MidiBuffer tempBuffer;
 